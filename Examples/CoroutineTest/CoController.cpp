@@ -0,0 +1,18 @@
+#include "CoController.h"
+
+#include <QThread>
+
+MC_STATIC()
+MC_REGISTER_BEAN_FACTORY(CoController)
+MC_STATIC_END
+
+CoController::CoController(QObject *parent)
+    : QObject(parent)
+{
+}
+
+int CoController::twice(int val)
+{
+    QThread::msleep(100);
+    return val * 2;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QObject>
+
+#include <McBoot/McBootGlobal.h>
+
+class CoController : public QObject
+{
+    Q_OBJECT
+    MC_TYPELIST();
+    MC_CONTROLLER("co")
+public:
+    Q_INVOKABLE explicit CoController(QObject *parent = nullptr);
+
+    Q_INVOKABLE int twice(int val);
+};
+
+MC_DECL_METATYPE(CoController)
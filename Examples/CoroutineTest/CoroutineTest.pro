@@ -0,0 +1,49 @@
+QT += quick
+
+TARGET = CoroutineTest
+
+# 协程需要C++20，common.pri默认使用C++17，包含之后再替换
+include($$PWD/../../common.pri)
+CONFIG -= c++17
+CONFIG += c++2a console
+CONFIG -= app_bundle
+
+# gcc 10需要显式开启协程，更高版本在C++20下默认开启
+gcc:!clang: QMAKE_CXXFLAGS += -fcoroutines
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+CONFIG(release, debug|release) {
+    DEFINES += QT_MESSAGELOGCONTEXT
+}
+
+DESTDIR = $$PWD/../../bin/Examples
+MOC_DIR = $$PWD/../../moc/Examples/CoroutineTest
+
+HEADERS += \
+    $$PWD/CoController.h
+
+SOURCES += \
+    $$PWD/CoController.cpp \
+    $$PWD/main.cpp
+
+include($$PWD/../../McQuickBoot/McQuickBootDepend.pri)
+
+win32 {
+    msvc {
+        CONFIG(release, debug|release): LIBS += -L$$PWD/../../bin/ -lMcQuickBoot
+        else:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../bin/ -lMcQuickBootd
+    } else {
+        LIBS += -L$$PWD/../../bin/ -lMcQuickBoot
+    }
+} else:unix:!macx {
+    LIBS += -L$$PWD/../../bin/ -lMcQuickBoot
+}
+
+INCLUDEPATH += $$PWD/../../McQuickBoot/include
+DEPENDPATH += $$PWD/../../McQuickBoot/include
+
+msvc {
+    QMAKE_CFLAGS += /utf-8
+    QMAKE_CXXFLAGS += /utf-8
+}
@@ -0,0 +1,46 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QThreadPool>
+
+#include <McBoot/McQuickBootSimple.h>
+#include <McBoot/Utils/McCoroutine.h>
+
+#ifndef MC_HAS_COROUTINE
+#error "CoroutineTest must be built with C++20 coroutine support"
+#endif
+
+using namespace Mc::QuickBoot;
+
+//! 两个请求依次执行，结果在主线程恢复
+McTask<int> sum()
+{
+    auto a = co_await awaitResponse<int>($.invoke("co.twice", 1));
+    auto b = co_await awaitResponse<int>($.invoke("co.twice", 2));
+    co_return a + b;
+}
+
+//! 在线程池中恢复，不需要事件循环
+McTask<int> sumInPool()
+{
+    auto pool = QThreadPool::globalInstance();
+    auto a = co_await awaitResponse<int>($.invoke("co.twice", 3), pool);
+    auto b = co_await awaitResponse<int>($.invoke("co.twice", 4), pool);
+    co_return a + b;
+}
+
+McTask<> run(QCoreApplication *app)
+{
+    qDebug() << "sum:" << co_await sum();
+    qDebug() << "sum in pool:" << co_await sumInPool();
+    QVariant body = co_await $.invoke("co.twice", 5);
+    qDebug() << "body:" << body;
+    app->quit();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    McQuickBootSimple::init();
+    auto task = run(&app);
+    return app.exec();
+}
@@ -2,7 +2,9 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     BootWidget \
+    CoroutineTest \
     IocTest \
+    LogBench \
     LogTest \
     QuickBootExample \
     ServiceTest \
@@ -0,0 +1,47 @@
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+# release下也保留file/function/line，测量拷贝它们的开销
+DEFINES += QT_MESSAGELOGCONTEXT
+
+SOURCES += \
+        main.cpp
+
+DESTDIR = $$PWD/../../bin/Examples
+MOC_DIR = $$PWD/../../moc/Examples/LogBench
+
+include($$PWD/../../common.pri)
+include($$PWD/../../McLogQt/McLogQtDepend.pri)
+
+win32 {
+    msvc {
+        CONFIG(release, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQt
+        else:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQtd
+    } else {
+        equals(QT_MAJOR_VERSION, 5):lessThan(QT_MINOR_VERSION, 13) {
+            CONFIG(release, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQt
+            else:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQtd
+        } else {
+            LIBS += -L$$PWD/../../bin/ -lMcLogQt
+        }
+    }
+} else:unix:!macx {
+    LIBS += -L$$PWD/../../bin/ -lMcLogQt
+}
+
+INCLUDEPATH += $$PWD/../../McLogQt/include
+DEPENDPATH += $$PWD/../../McLogQt/include
+
+# 将/替换为\\才能正确识别路径
+SrcConfigPath = $$PWD/logbench.xml
+DstConfigPath = $$PWD/../../bin/Examples/
+win32 {
+    SrcConfigPath = $$replace(SrcConfigPath, /, \\)
+    DstConfigPath = $$replace(DstConfigPath, /, \\)
+    QMAKE_POST_LINK += copy /y $$SrcConfigPath $$DstConfigPath
+} else {
+    QMAKE_POST_LINK += cp $$SrcConfigPath $$DstConfigPath
+}
@@ -0,0 +1,126 @@
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include <QtDebug>
+
+#include <McIoc/ApplicationContext/IMcApplicationContext.h>
+
+#include "McLog/Appender/impl/McFileAppender.h"
+#include "McLog/Configurator/McXMLConfigurator.h"
+#include "McLog/Layout/impl/McPatternLayout.h"
+
+namespace {
+
+constexpr int kRounds = 5;
+constexpr int kLines = 200000;
+constexpr int kBatch = 64; //!< 写出线程每批处理的记录数，kLines须是它的整数倍
+
+//! 返回调用线程上每条日志的平均耗时，单位ns
+double measure(const char *category) noexcept
+{
+    QLoggingCategory logger(category);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kLines; ++i) {
+        qInfo(logger) << "bench line" << i << "value:" << i * 0.5;
+    }
+    return static_cast<double>(timer.nsecsElapsed()) / kLines;
+}
+
+QVector<McLogRecord> makeRecords() noexcept
+{
+    QVector<McLogRecord> records;
+    records.reserve(kBatch);
+    QMessageLogContext context(__FILE__, __LINE__, Q_FUNC_INFO, "bench");
+    for (int i = 0; i < kBatch; ++i) {
+        auto msg = QStringLiteral("bench line %1 value: %2").arg(i).arg(i * 0.5);
+        records.append(McLogRecord::capture(QtInfoMsg, context, msg));
+    }
+    return records;
+}
+
+//! 旧的写出方式：格式化为QString，拼接成一批后交给QTextStream编码写出。返回每条记录的平均耗时，单位ns
+double measureTextStream(IMcLayout *layout, const QVector<McLogRecord> &records) noexcept
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QTextStream stream(&buffer);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kLines; i += kBatch) {
+        QString batch;
+        for (auto &record : records) {
+            batch += layout->formatRecord(record);
+            batch += QLatin1Char('\n');
+        }
+        stream << batch;
+        stream.flush();
+        buffer.seek(0);
+    }
+    return static_cast<double>(timer.nsecsElapsed()) / kLines;
+}
+
+//! 现在的写出方式：直接按UTF-8格式化到一批字节中再写入设备。返回每条记录的平均耗时，单位ns
+double measureUtf8(IMcLayout *layout, const QVector<McLogRecord> &records) noexcept
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kLines; i += kBatch) {
+        QByteArray batch;
+        for (auto &record : records) {
+            layout->formatRecordUtf8(record, batch);
+            batch += '\n';
+        }
+        buffer.write(batch);
+        buffer.seek(0);
+    }
+    return static_cast<double>(timer.nsecsElapsed()) / kLines;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    auto appCtx = McXMLConfigurator::configure(QStringLiteral("./logbench.xml"));
+
+    double totals[2] = {0, 0};
+    const char *categories[2] = {"immediate", "deferred"};
+    for (int round = 0; round < kRounds; ++round) {
+        //! 两种模式交替执行，避免先后顺序带来的偏差
+        for (int i = 0; i < 2; ++i) {
+            auto idx = (round + i) % 2;
+            totals[idx] += measure(categories[idx]);
+            //! 等待写出线程清空队列，不与下一轮争抢CPU
+            QThread::sleep(2);
+        }
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        auto appender = appCtx->getBean<McFileAppender>(QString::fromLatin1(categories[i]));
+        fprintf(stdout,
+                "%-10s %8.1f ns/line  blocked: %lld ms  dropped: %llu\n",
+                categories[i],
+                totals[i] / kRounds,
+                static_cast<long long>(appender->blockedMsecs()),
+                static_cast<unsigned long long>(appender->droppedCount()));
+    }
+
+    //! 写出线程上格式化并写出一批记录的耗时，比较QTextStream和直接写出UTF-8
+    auto layout = appCtx->getBean<McPatternLayout>(QStringLiteral("patternLayout"));
+    auto records = makeRecords();
+    double encodeTotals[2] = {0, 0};
+    for (int round = 0; round < kRounds; ++round) {
+        encodeTotals[0] += measureTextStream(layout.data(), records);
+        encodeTotals[1] += measureUtf8(layout.data(), records);
+    }
+    fprintf(stdout, "%-10s %8.1f ns/line\n", "textstream", encodeTotals[0] / kRounds);
+    fprintf(stdout, "%-10s %8.1f ns/line\n", "utf8", encodeTotals[1] / kRounds);
+    fflush(stdout);
+    return 0;
+}
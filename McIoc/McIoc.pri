@@ -63,6 +63,7 @@ HEADERS += \
     $$PWD/include/McIoc/Utils/Macro/MacroSize.h \
     $$PWD/include/McIoc/Utils/McQVariantConverter.h \
     $$PWD/include/McIoc/Utils/McScopedFunction.h \
+    $$PWD/include/McIoc/Utils/McWaitNotifier.h \
     $$PWD/include/McIoc/McGlobal.h \
     $$PWD/include/McIoc/McMacroGlobal.h \
     $$PWD/include/McIoc/Utils/XmlBuilder/impl/McBean.h \
@@ -111,6 +112,7 @@ SOURCES += \
     $$PWD/src/McGlobal.cpp \
     $$PWD/src/Utils/Event/McEventDispatcher.cpp \
     $$PWD/src/Utils/Event/McEventRouter.cpp \
+    $$PWD/src/Utils/McWaitNotifier.cpp \
     $$PWD/src/Utils/XmlBuilder/McBeanCollection.cpp \
     $$PWD/src/Utils/XmlBuilder/McBean.cpp \
     $$PWD/src/Utils/XmlBuilder/McPlaceholder.cpp \
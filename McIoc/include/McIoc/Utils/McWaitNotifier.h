@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <functional>
+
+#include "../McMacroGlobal.h"
+
+MC_FORWARD_DECL_PRIVATE_DATA(McWaitNotifier);
+
+/*!
+ * \brief The McWaitNotifier class
+ * 由状态改变的一方调用notify，等待的一方直接阻塞在通知上，而不是定时轮询。
+ * 主线程或需要处理本线程事件时运行一个事件循环，收到通知即退出；
+ * 其他线程阻塞在条件变量上。超时使用Qt::PreciseTimer精确计算。
+ * 通常以McWaitNotifierPtr共享持有，这样被等待的对象在等待期间析构也是安全的
+ */
+class MCIOC_EXPORT McWaitNotifier
+{
+public:
+    McWaitNotifier() noexcept;
+    ~McWaitNotifier();
+
+    bool isNotified() const noexcept;
+    //! 置为已通知状态，并唤醒所有等待者
+    void notify() noexcept;
+    void reset() noexcept;
+
+    //! 等待直到notify被调用或超时，timeout为-1表示永不超时
+    bool wait(qint64 timeout = -1, bool processEvents = false) noexcept;
+    //! 等待直到func返回true或超时，每次notify后重新执行func
+    bool wait(const std::function<bool()> &func,
+              qint64 timeout = -1,
+              bool processEvents = false) noexcept;
+
+private:
+    Q_DISABLE_COPY(McWaitNotifier)
+    MC_DECL_PRIVATE(McWaitNotifier)
+};
+
+MC_DECL_POINTER(McWaitNotifier)
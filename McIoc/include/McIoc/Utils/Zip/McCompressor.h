@@ -25,9 +25,12 @@
 
 #include "../../McMacroGlobal.h"
 
+#include <functional>
+
 #include <QString>
 
 class QuaZip;
+class QIODevice;
 
 class MCIOC_EXPORT McCompressor
 {
@@ -39,7 +42,30 @@ public:
                               const QString &rootPath = QString()) noexcept;
     static bool compressFiles(const QString &fileCompressed,
                               QMap<QString, QStringList> filePaths) noexcept;
+    /*!
+     * \brief gzipFile
+     * 
+     * 以固定大小的缓冲区流式地将文件压缩为gzip格式，完成后会重新解压校验长度和CRC。
+     * maxBytesPerSecond大于0时限制读取速度，避免与其他磁盘读写争抢。
+     * 每读取一块都会调用isCanceled，返回true时中止并视为失败。
+     * 失败时删除不完整的压缩文件，不会修改原文件
+     */
+    static bool gzipFile(const QString &fileName,
+                         const QString &fileCompressed,
+                         qint64 maxBytesPerSecond = 0,
+                         const std::function<bool()> &isCanceled = std::function<bool()>()) noexcept;
+    /*!
+     * \brief gunzipRange
+     * 
+     * 流式解压gzip文件，只把解压后位于[offset, offset + size)的数据写入out，size为-1时写到结尾。
+     * gzip不支持随机访问，offset之前的数据仍需解压，但不会保存
+     */
+    static bool gunzipRange(const QString &fileCompressed,
+                            qint64 offset,
+                            qint64 size,
+                            QIODevice *out) noexcept;
 
 private:
     static bool compressFile(QuaZip *zip, const QString &fileName, const QString &fileDest) noexcept;
+    static bool verifyGzipFile(const QString &fileCompressed, qint64 size) noexcept;
 };
@@ -26,12 +26,9 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
-#include <QElapsedTimer>
-#include <QEventLoop>
 #include <QMetaClassInfo>
 #include <QMetaObject>
 #include <QStandardPaths>
-#include <QTimer>
 #include <QUrl>
 
 #include "McIoc/ApplicationContext/impl/McAnnotationApplicationContext.h"
@@ -161,33 +158,6 @@ void init() noexcept
 } // namespace Ioc
 #endif
 
-bool waitForExecFunc(const std::function<bool()> &func, qint64 timeout) noexcept 
-{
-    QEventLoop loop;
-    QTimer timer;
-    timer.setInterval(100);
-    QElapsedTimer stopWatcher;
-    bool ret = true;
-    
-    QObject::connect(&timer, &QTimer::timeout, [&timer, &stopWatcher, &loop, &ret, &func, &timeout](){
-        timer.stop();
-        if((ret = func())) {
-            loop.quit();
-            return;
-        }
-        if(timeout != -1 && stopWatcher.elapsed() > timeout) {
-            loop.quit();
-            return;
-        }
-        timer.start();
-    });
-    
-    stopWatcher.start();
-    timer.start();
-    loop.exec();
-    return ret;
-}
-
 QString toAbsolutePath(const QString &inPath) noexcept
 {
     static QHash<QString, QStandardPaths::StandardLocation> pathPlhs{{"{desktop}", QStandardPaths::DesktopLocation},
@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McIoc/Utils/McWaitNotifier.h"
+
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QEventLoop>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+
+MC_DECL_PRIVATE_DATA(McWaitNotifier)
+QAtomicInteger<bool> isNotified{false};
+QMutex mtx;
+QWaitCondition cond;
+QList<QEventLoop *> loops;
+MC_DECL_PRIVATE_DATA_END
+
+McWaitNotifier::McWaitNotifier() noexcept
+{
+    MC_NEW_PRIVATE_DATA(McWaitNotifier);
+}
+
+McWaitNotifier::~McWaitNotifier() {}
+
+bool McWaitNotifier::isNotified() const noexcept
+{
+    return d->isNotified.loadAcquire();
+}
+
+void McWaitNotifier::notify() noexcept
+{
+    d->isNotified.storeRelease(true);
+    QMutexLocker locker(&d->mtx);
+    d->cond.wakeAll();
+    for (auto loop : qAsConst(d->loops)) {
+        //! 事件循环可能处于其他线程，必须以队列方式退出
+        QMetaObject::invokeMethod(loop, "quit", Qt::QueuedConnection);
+    }
+}
+
+void McWaitNotifier::reset() noexcept
+{
+    d->isNotified.storeRelease(false);
+}
+
+bool McWaitNotifier::wait(qint64 timeout, bool processEvents) noexcept
+{
+    return wait([this]() { return isNotified(); }, timeout, processEvents);
+}
+
+bool McWaitNotifier::wait(const std::function<bool()> &func,
+                          qint64 timeout,
+                          bool processEvents) noexcept
+{
+    QDeadlineTimer deadline = timeout < 0 ? QDeadlineTimer(QDeadlineTimer::Forever)
+                                          : QDeadlineTimer(timeout, Qt::PreciseTimer);
+    auto app = QCoreApplication::instance();
+    if (!processEvents && (app == nullptr || QThread::currentThread() != app->thread())) {
+        QMutexLocker locker(&d->mtx);
+        while (!func()) {
+            if (!d->cond.wait(&d->mtx, deadline)) {
+                return func();
+            }
+        }
+        return true;
+    }
+    forever {
+        QEventLoop loop;
+        {
+            QMutexLocker locker(&d->mtx);
+            if (func()) {
+                return true;
+            }
+            if (deadline.hasExpired()) {
+                return false;
+            }
+            d->loops.append(&loop);
+        }
+        QTimer timer;
+        timer.setSingleShot(true);
+        timer.setTimerType(Qt::PreciseTimer);
+        if (!deadline.isForever()) {
+            QObject::connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+            timer.start(static_cast<int>(qMax<qint64>(0, deadline.remainingTime())));
+        }
+        auto ret = loop.exec();
+        QMutexLocker locker(&d->mtx);
+        d->loops.removeOne(&loop);
+        if (ret == -1) { //!< 当前线程正在退出，事件循环无法运行
+            return func();
+        }
+    }
+}
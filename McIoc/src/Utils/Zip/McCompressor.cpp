@@ -23,10 +23,19 @@
  */
 #include "McIoc/Utils/Zip/McCompressor.h"
 
+#include <limits>
+
+#include <QElapsedTimer>
+#include <QScopeGuard>
+#include <QThread>
+
 #include "JlCompress.h"
+#include "zlib.h"
 
 namespace {
 
+constexpr int kGzipChunkSize = 64 * 1024;
+
 static bool copyData(QIODevice &inFile, QIODevice &outFile)
 {
     while (!inFile.atEnd()) {
@@ -144,3 +153,168 @@ bool McCompressor::compressFile(QuaZip *zip,
 
     return true;
 }
+
+bool McCompressor::gzipFile(const QString &fileName,
+                            const QString &fileCompressed,
+                            qint64 maxBytesPerSecond,
+                            const std::function<bool()> &isCanceled) noexcept
+{
+    QFile inFile(fileName);
+    if (!inFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDir().mkpath(QFileInfo(fileCompressed).absolutePath());
+    QFile outFile(fileCompressed);
+    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    auto failed = [&outFile]() {
+        outFile.close();
+        outFile.remove();
+        return false;
+    };
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    //! windowBits加16表示输出gzip头和尾，memLevel取8为zlib默认值
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return failed();
+    }
+    auto cleanup = qScopeGuard([&stream]() { deflateEnd(&stream); });
+
+    QByteArray in(kGzipChunkSize, Qt::Uninitialized);
+    QByteArray out(kGzipChunkSize, Qt::Uninitialized);
+    qint64 totalRead = 0;
+    QElapsedTimer timer;
+    timer.start();
+    int flush = Z_NO_FLUSH;
+    do {
+        if (isCanceled && isCanceled()) {
+            return failed();
+        }
+        auto readLen = inFile.read(in.data(), in.size());
+        if (readLen < 0) {
+            return failed();
+        }
+        totalRead += readLen;
+        flush = inFile.atEnd() ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = reinterpret_cast<Bytef *>(in.data());
+        stream.avail_in = static_cast<uInt>(readLen);
+        do {
+            stream.next_out = reinterpret_cast<Bytef *>(out.data());
+            stream.avail_out = static_cast<uInt>(out.size());
+            if (deflate(&stream, flush) == Z_STREAM_ERROR) {
+                return failed();
+            }
+            auto have = out.size() - static_cast<int>(stream.avail_out);
+            if (outFile.write(out.constData(), have) != have) {
+                return failed();
+            }
+        } while (stream.avail_out == 0);
+        //! 读取超过限速时休眠到对应时刻
+        if (maxBytesPerSecond > 0) {
+            auto expected = totalRead * 1000 / maxBytesPerSecond;
+            auto elapsed = timer.elapsed();
+            if (expected > elapsed) {
+                QThread::msleep(static_cast<unsigned long>(expected - elapsed));
+            }
+        }
+    } while (flush != Z_FINISH);
+
+    if (!outFile.flush()) {
+        return failed();
+    }
+    outFile.close();
+    if (!verifyGzipFile(fileCompressed, totalRead)) {
+        outFile.remove();
+        return false;
+    }
+    return true;
+}
+
+bool McCompressor::gunzipRange(const QString &fileCompressed,
+                               qint64 offset,
+                               qint64 size,
+                               QIODevice *out) noexcept
+{
+    QFile inFile(fileCompressed);
+    if (out == nullptr || !inFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return false;
+    }
+    auto cleanup = qScopeGuard([&stream]() { inflateEnd(&stream); });
+
+    auto end = size < 0 ? std::numeric_limits<qint64>::max() : offset + size;
+    QByteArray in(kGzipChunkSize, Qt::Uninitialized);
+    QByteArray buf(kGzipChunkSize, Qt::Uninitialized);
+    qint64 pos = 0; //!< 已解压的数据在原文件中的位置
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END && pos < end) {
+        auto readLen = inFile.read(in.data(), in.size());
+        if (readLen <= 0) {
+            return false;
+        }
+        stream.next_in = reinterpret_cast<Bytef *>(in.data());
+        stream.avail_in = static_cast<uInt>(readLen);
+        do {
+            stream.next_out = reinterpret_cast<Bytef *>(buf.data());
+            stream.avail_out = static_cast<uInt>(buf.size());
+            ret = inflate(&stream, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                return false;
+            }
+            qint64 have = buf.size() - static_cast<int>(stream.avail_out);
+            //! 只写出与目标范围相交的部分
+            auto begin = qMax(pos, offset);
+            auto stop = qMin(pos + have, end);
+            if (stop > begin && out->write(buf.constData() + (begin - pos), stop - begin) != stop - begin) {
+                return false;
+            }
+            pos += have;
+        } while (stream.avail_out == 0 && ret != Z_STREAM_END && pos < end);
+    }
+    return true;
+}
+
+bool McCompressor::verifyGzipFile(const QString &fileCompressed, qint64 size) noexcept
+{
+    QFile inFile(fileCompressed);
+    if (!inFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return false;
+    }
+    auto cleanup = qScopeGuard([&stream]() { inflateEnd(&stream); });
+
+    QByteArray in(kGzipChunkSize, Qt::Uninitialized);
+    QByteArray out(kGzipChunkSize, Qt::Uninitialized);
+    qint64 totalOut = 0;
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+        auto readLen = inFile.read(in.data(), in.size());
+        if (readLen <= 0) {
+            return false;
+        }
+        stream.next_in = reinterpret_cast<Bytef *>(in.data());
+        stream.avail_in = static_cast<uInt>(readLen);
+        do {
+            stream.next_out = reinterpret_cast<Bytef *>(out.data());
+            stream.avail_out = static_cast<uInt>(out.size());
+            //! gzip尾部的CRC32由inflate在Z_STREAM_END前自动校验
+            ret = inflate(&stream, Z_NO_FLUSH);
+            //! Z_BUF_ERROR只表示本次没有进展，读入更多数据后可继续
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                return false;
+            }
+            totalOut += out.size() - static_cast<int>(stream.avail_out);
+        } while (stream.avail_out == 0 && ret != Z_STREAM_END);
+    }
+    return totalOut == size;
+}
@@ -11,7 +11,9 @@ SOURCES += \
     $$PWD/src/Appender/Decorator/McAbstractAppenderDecorator.cpp \
     $$PWD/src/Appender/Decorator/McAppenderFrontDecorator.cpp \
     $$PWD/src/Appender/Decorator/McAppenderPostDecorator.cpp \
+    $$PWD/src/Appender/Decorator/McAppenderRateLimitDecorator.cpp \
     $$PWD/src/Appender/McAbstractAppender.cpp \
+    $$PWD/src/Appender/McBinaryFileAppender.cpp \
     $$PWD/src/Appender/McByDayRollingFileAppender.cpp \
     $$PWD/src/Appender/McBySizeDailyRollingFileAppender.cpp \
     $$PWD/src/Appender/McBySizeDayRollingFileAppender.cpp \
@@ -19,13 +21,17 @@ SOURCES += \
     $$PWD/src/Appender/McDailyRollingFileAppender.cpp \
     $$PWD/src/Appender/McFileAppender.cpp \
     $$PWD/src/Appender/McFileDeviceAppender.cpp \
+    $$PWD/src/Appender/McMmapFileAppender.cpp \
     $$PWD/src/Appender/McRollingFileAppender.cpp \
     $$PWD/src/Appender/McSizeRollingFileAppender.cpp \
+    $$PWD/src/Appender/McSyslogAppender.cpp \
     $$PWD/src/Configurator/McDefaultConfigurator.cpp \
     $$PWD/src/Configurator/McINIConfigurator.cpp \
     $$PWD/src/Configurator/McSettingConfigurator.cpp \
     $$PWD/src/Configurator/McXMLConfigurator.cpp \
+    $$PWD/src/Device/McMmapFileDevice.cpp \
     $$PWD/src/Device/McVSDebugDevice.cpp \
+    $$PWD/src/Layout/McJsonLayout.cpp \
     $$PWD/src/Layout/McNormalLayout.cpp \
     $$PWD/src/Layout/McPatternLayout.cpp \
     $$PWD/src/Layout/McSimpleLayout.cpp \
@@ -37,13 +43,21 @@ SOURCES += \
     $$PWD/src/Repository/McLoggerRepository.cpp \
     $$PWD/src/Appender/McAbstractFormatAppender.cpp \
     $$PWD/src/Utils/Deleter/McLogDeleter.cpp \
+    $$PWD/src/Utils/McBinaryLog.cpp \
     $$PWD/src/Utils/McFileUtils.cpp \
+    $$PWD/src/Utils/McLogCrashHandler.cpp \
+    $$PWD/src/Utils/McLogFileIndex.cpp \
+    $$PWD/src/Utils/McLogMaintainer.cpp \
+    $$PWD/src/Utils/McLogMdc.cpp \
+    $$PWD/src/Utils/McLogRecord.cpp \
+    $$PWD/src/Utils/McLogTimeIndex.cpp \
     $$PWD/src/Utils/McMessagePattern.cpp
 
 HEADERS += \
     $$PWD/include/McLog/Appender/Decorator/McAbstractAppenderDecorator.h \
     $$PWD/include/McLog/Appender/Decorator/McAppenderFrontDecorator.h \
     $$PWD/include/McLog/Appender/Decorator/McAppenderPostDecorator.h \
+    $$PWD/include/McLog/Appender/Decorator/McAppenderRateLimitDecorator.h \
     $$PWD/include/McLog/Appender/Decorator/McAppenderSeparator.h \
     $$PWD/include/McLog/Appender/IMcAppender.h \
     $$PWD/include/McLog/Appender/IMcCodecableAppender.h \
@@ -52,6 +66,7 @@ HEADERS += \
     $$PWD/include/McLog/Appender/IMcWritableAppender.h \
     $$PWD/include/McLog/Appender/impl/McAbstractAppender.h \
     $$PWD/include/McLog/Appender/impl/McAbstractIODeviceAppender.h \
+    $$PWD/include/McLog/Appender/impl/McBinaryFileAppender.h \
     $$PWD/include/McLog/Appender/impl/McByDayRollingFileAppender.h \
     $$PWD/include/McLog/Appender/impl/McBySizeDailyRollingFileAppender.h \
     $$PWD/include/McLog/Appender/impl/McBySizeDayRollingFileAppender.h \
@@ -59,15 +74,19 @@ HEADERS += \
     $$PWD/include/McLog/Appender/impl/McDailyRollingFileAppender.h \
     $$PWD/include/McLog/Appender/impl/McFileAppender.h \
     $$PWD/include/McLog/Appender/impl/McFileDeviceAppender.h \
+    $$PWD/include/McLog/Appender/impl/McMmapFileAppender.h \
     $$PWD/include/McLog/Appender/impl/McRollingFileAppender.h \
     $$PWD/include/McLog/Appender/impl/McSizeRollingFileAppender.h \
+    $$PWD/include/McLog/Appender/impl/McSyslogAppender.h \
     $$PWD/include/McLog/Appender/impl/McVSDebugAppender.h \
     $$PWD/include/McLog/Configurator/McDefaultConfigurator.h \
     $$PWD/include/McLog/Configurator/McINIConfigurator.h \
     $$PWD/include/McLog/Configurator/McSettingConfigurator.h \
     $$PWD/include/McLog/Configurator/McXMLConfigurator.h \
+    $$PWD/include/McLog/Device/McMmapFileDevice.h \
     $$PWD/include/McLog/Device/McVSDebugDevice.h \
     $$PWD/include/McLog/Layout/IMcLayout.h \
+    $$PWD/include/McLog/Layout/impl/McJsonLayout.h \
     $$PWD/include/McLog/Layout/impl/McNormalLayout.h \
     $$PWD/include/McLog/Layout/impl/McPatternLayout.h \
     $$PWD/include/McLog/Layout/impl/McSimpleLayout.h \
@@ -82,7 +101,15 @@ HEADERS += \
     $$PWD/include/McLog/Repository/impl/McLoggerRepository.h \
     $$PWD/include/McLog/Appender/impl/McAbstractFormatAppender.h \
     $$PWD/include/McLog/Utils/Deleter/McLogDeleter.h \
+    $$PWD/include/McLog/Utils/McBinaryLog.h \
     $$PWD/include/McLog/Utils/McFileUtils.h \
-    $$PWD/include/McLog/Utils/McMessagePattern.h
+    $$PWD/include/McLog/Utils/McLogCrashHandler.h \
+    $$PWD/include/McLog/Utils/McLogFileIndex.h \
+    $$PWD/include/McLog/Utils/McLogMaintainer.h \
+    $$PWD/include/McLog/Utils/McLogMdc.h \
+    $$PWD/include/McLog/Utils/McLogRecord.h \
+    $$PWD/include/McLog/Utils/McLogTimeIndex.h \
+    $$PWD/include/McLog/Utils/McMessagePattern.h \
+    $$PWD/include/McLog/Utils/McRingBuffer.h
 
 RESOURCES +=
@@ -29,6 +29,9 @@ include($$PWD/../common.pri)
 include($$PWD/McLogQt.pri)
 include($$PWD/McLogQtDepend.pri)
 
+# McSyslogAppender使用winsock
+win32: LIBS += -lws2_32
+
 DESTDIR = $$PWD/../bin
 MOC_DIR = $$PWD/../moc/McLogQt
 
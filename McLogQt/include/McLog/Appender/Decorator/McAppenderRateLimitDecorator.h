@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "McAbstractAppenderDecorator.h"
+
+MC_FORWARD_DECL_PRIVATE_DATA(McAppenderRateLimitDecorator);
+
+/*!
+ * \brief The McAppenderRateLimitDecorator class
+ * 
+ * 同一位置(文件、行号)打印的相同消息在dedupWindow毫秒内只输出第一条，
+ * 窗口结束时输出一条带重复次数的汇总。
+ * 同时按category使用令牌桶限制每秒输出的消息数，被丢弃的数量会定期汇总输出。
+ * QtFatalMsg不受限制
+ */
+class MCLOGQT_EXPORT McAppenderRateLimitDecorator
+        : public McAbstractAppenderDecorator
+{
+    Q_OBJECT
+    MC_DECL_INIT(McAppenderRateLimitDecorator)
+    MC_TYPELIST(McAbstractAppenderDecorator);
+    Q_PROPERTY(int dedupWindow READ dedupWindow WRITE setDedupWindow)
+    Q_PROPERTY(int rateLimit READ rateLimit WRITE setRateLimit)
+    Q_PROPERTY(int burst READ burst WRITE setBurst)
+public:
+    Q_INVOKABLE explicit McAppenderRateLimitDecorator(QObject *parent = nullptr);
+    ~McAppenderRateLimitDecorator() override;
+
+    int dedupWindow() const noexcept;
+    void setDedupWindow(int val) noexcept;
+
+    int rateLimit() const noexcept;
+    void setRateLimit(int val) noexcept;
+
+    int burst() const noexcept;
+    void setBurst(int val) noexcept;
+
+    void append(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept override;
+
+    void finished() noexcept override;
+
+protected:
+    void doAppend(IMcConfigurableAppenderConstPtrRef appender, QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept override;
+
+private:
+    bool isDuplicate(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept;
+    bool tryAcquire(const QMessageLogContext &context) noexcept;
+    void flushSummaries() noexcept;
+    void appendSummary(QtMsgType type,
+                       const QByteArray &file,
+                       int line,
+                       const QByteArray &function,
+                       const QByteArray &category,
+                       const QString &message) noexcept;
+
+private:
+    MC_DECL_PRIVATE(McAppenderRateLimitDecorator)
+};
+
+MC_DECL_METATYPE(McAppenderRateLimitDecorator)
@@ -24,11 +24,14 @@
 #pragma once
 
 #include "McAbstractIODeviceAppender.h"
+#include "../../Utils/McLogTimeIndex.h"
 
 Q_MOC_INCLUDE("McLog/Layout/IMcLayout.h")
 
 MC_FORWARD_DECL_CLASS(IMcLayout);
 
+struct McLogRecord;
+
 MC_FORWARD_DECL_PRIVATE_DATA(McAbstractFormatAppender);
 
 class MCLOGQT_EXPORT McAbstractFormatAppender
@@ -43,6 +46,20 @@ class MCLOGQT_EXPORT McAbstractFormatAppender
     Q_PROPERTY(bool useLockFile READ useLockFile WRITE setUseLockFile)
     Q_PROPERTY(bool isPrintError READ isPrintError WRITE setPrintError)
     Q_PROPERTY(QString lockFilePath READ lockFilePath WRITE setLockFilePath)
+    Q_PROPERTY(int queueCapacity READ queueCapacity WRITE setQueueCapacity)
+    Q_PROPERTY(QString durability READ durability WRITE setDurability)
+    Q_PROPERTY(int fsyncInterval READ fsyncInterval WRITE setFsyncInterval)
+    Q_PROPERTY(bool deferredFormat READ deferredFormat WRITE setDeferredFormat)
+    Q_PROPERTY(bool multiProcess READ multiProcess WRITE setMultiProcess)
+    Q_PROPERTY(int atomicWriteSize READ atomicWriteSize WRITE setAtomicWriteSize)
+    Q_PROPERTY(QString overflowPolicy READ overflowPolicy WRITE setOverflowPolicy)
+    Q_PROPERTY(int blockTimeout READ blockTimeout WRITE setBlockTimeout)
+    Q_PROPERTY(QString dropThreshold READ dropThreshold WRITE setDropThreshold)
+    Q_PROPERTY(int sampleRate READ sampleRate WRITE setSampleRate)
+    Q_PROPERTY(int statsInterval READ statsInterval WRITE setStatsInterval)
+    Q_PROPERTY(quint64 enqueuedCount READ enqueuedCount)
+    Q_PROPERTY(quint64 droppedCount READ droppedCount)
+    Q_PROPERTY(qint64 blockedMsecs READ blockedMsecs)
 public:
     McAbstractFormatAppender();
     ~McAbstractFormatAppender() override;
@@ -62,10 +79,62 @@ public:
     QString lockFilePath() const noexcept;
     void setLockFilePath(const QString &val) noexcept;
 
+    int queueCapacity() const noexcept;
+    void setQueueCapacity(int val) noexcept;
+
+    QString durability() const noexcept;
+    void setDurability(const QString &val) noexcept;
+
+    int fsyncInterval() const noexcept;
+    void setFsyncInterval(int val) noexcept;
+
+    bool deferredFormat() const noexcept;
+    void setDeferredFormat(bool val) noexcept;
+
+    bool multiProcess() const noexcept;
+    void setMultiProcess(bool val) noexcept;
+
+    int atomicWriteSize() const noexcept;
+    void setAtomicWriteSize(int val) noexcept;
+
+    //! 队列已满时的策略，可选block/dropNewest/dropBelow/sample
+    QString overflowPolicy() const noexcept;
+    void setOverflowPolicy(const QString &val) noexcept;
+
+    //! 阻塞等待的最长时间，单位毫秒，-1表示一直等待。超时后丢弃
+    int blockTimeout() const noexcept;
+    void setBlockTimeout(int val) noexcept;
+
+    //! dropBelow策略下低于此等级的消息直接丢弃，其余消息按block处理
+    QString dropThreshold() const noexcept;
+    void setDropThreshold(const QString &val) noexcept;
+
+    //! sample策略下每sampleRate条消息保留一条，保留的消息按block处理
+    int sampleRate() const noexcept;
+    void setSampleRate(int val) noexcept;
+
+    //! 输出队列统计信息的间隔，单位毫秒，0表示不输出
+    int statsInterval() const noexcept;
+    void setStatsInterval(int val) noexcept;
+
+    quint64 enqueuedCount() const noexcept;
+    quint64 droppedCount() const noexcept;
+    //! 生产者因队列已满而挂起的累计时间，等待期间线程阻塞在条件变量上，不占用CPU
+    qint64 blockedMsecs() const noexcept;
+
     void append(QtMsgType type,
                 const QMessageLogContext &context,
                 const QString &str) noexcept override;
 
+    /*!
+     * \brief emergencyFlush
+     * 
+     * qFatal时由McLogCrashHandler::flushAll调用，绕过事件循环把缓冲和队列中的记录直接write到文件。
+     * 需要格式化和分配内存，不能在信号处理函数中调用。
+     * 写出线程正在写设备时跳过。调用后不再释放写权限，之后的写出都会被丢弃
+     */
+    void emergencyFlush() noexcept;
+
 protected:
     void doFinished() noexcept override;
     void doThreadFinished() noexcept override;
@@ -75,9 +144,32 @@ protected:
     
     virtual void writeBefore() noexcept = 0;
     virtual void writeAfter() noexcept = 0;
+
+    //! 当前设备已写入的字节数(含尚在缓冲区中的数据)，切换文件时由子类重置
+    qint64 bytesWritten() const noexcept;
+    void setBytesWritten(qint64 val) noexcept;
+
+    //! 时间索引的时间桶长度(毫秒)，大于0时写出线程记录每个时间桶第一条记录在本批消息中的位置
+    virtual qint64 timeIndexInterval() const noexcept { return 0; }
+    //! 一批消息写出后调用，entries中的偏移量已换算为设备中的绝对位置
+    virtual void writeTimeIndex(const QVector<McLogTimeIndex::Entry> &entries) noexcept
+    {
+        Q_UNUSED(entries)
+    }
+    //! 设备打开或关闭后调用，向McLogCrashHandler登记文件描述符，崩溃时尚未写出的记录直接写入该文件
+    void updateCrashFd() noexcept;
     
 private:
     Q_INVOKABLE void append_helper(const QString &msg) noexcept;
+    void enqueue(McLogRecord &&record) noexcept;
+    bool shouldWaitWhenFull(QtMsgType type) noexcept;
+    void appendStats(QByteArray &batch, const QByteArray &separator) noexcept;
+    void scheduleDrain() noexcept;
+    void drainQueue() noexcept;
+    void writeBatch(const QByteArray &batch) noexcept;
+    void writeAtomic(const QByteArray &data) noexcept;
+    void syncDevice() noexcept;
+    QString lineSeparator() const noexcept;
     
 private:
     MC_DECL_PRIVATE(McAbstractFormatAppender)
@@ -53,7 +53,14 @@ protected:
     void doAllFinished() noexcept override;
 
 protected:
-    QTextStream &textStream() noexcept;
+    //! codec是否为UTF-8，为true时writeUtf8不需要转换编码
+    bool isUtf8() const noexcept;
+    //! 将UTF-8数据转换为codec的编码
+    QByteArray encodeUtf8(const QByteArray &data) const noexcept;
+    //! 写出UTF-8编码的数据，codec不是UTF-8时先转换编码，返回实际写出的字节数
+    qint64 writeUtf8(const QByteArray &data) noexcept;
+    //! 将QFileDevice缓冲区中的数据交给操作系统
+    void flushDevice() noexcept;
 
 private:
     MC_DECL_PRIVATE(McAbstractIODeviceAppender)
@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "McAbstractAppender.h"
+
+MC_FORWARD_DECL_PRIVATE_DATA(McBinaryFileAppender);
+
+/*!
+ * \brief The McBinaryFileAppender class
+ * 不经过layout，将原始日志记录以紧凑的二进制格式写入文件，格式见McBinaryLog.h。
+ * category/file/function在每个文件中只写出一次，之后以编号引用。
+ * 写出的文件可以用McLogDecoder按任意McPatternLayout的pattern转换为文本
+ */
+class MCLOGQT_EXPORT McBinaryFileAppender : public McAbstractAppender
+{
+    Q_OBJECT
+    MC_DECL_SUPER(McAbstractAppender)
+    MC_DECL_INIT(McBinaryFileAppender)
+    MC_TYPELIST(McAbstractAppender)
+    Q_PROPERTY(QString dirPath READ dirPath WRITE setDirPath)
+    Q_PROPERTY(QString fileNamePattern READ fileNamePattern WRITE setFileNamePattern)
+    Q_PROPERTY(QString maxFileSize READ maxFileSize WRITE setMaxFileSize)
+    Q_PROPERTY(int queueCapacity READ queueCapacity WRITE setQueueCapacity)
+public:
+    Q_INVOKABLE McBinaryFileAppender();
+    ~McBinaryFileAppender() override;
+
+    QString dirPath() const noexcept;
+    void setDirPath(const QString &val) noexcept;
+
+    QString fileNamePattern() const noexcept;
+    void setFileNamePattern(const QString &val) noexcept;
+
+    QString maxFileSize() const noexcept;
+    void setMaxFileSize(const QString &val) noexcept;
+
+    int queueCapacity() const noexcept;
+    void setQueueCapacity(int val) noexcept;
+
+    void append(QtMsgType type,
+                const QMessageLogContext &context,
+                const QString &str) noexcept override;
+
+protected:
+    void doFinished() noexcept override;
+
+    void customEvent(QEvent *event) override;
+
+private:
+    void scheduleDrain() noexcept;
+    void drainQueue() noexcept;
+    int writeQueued(int maxCount) noexcept;
+    bool openNewFile() noexcept;
+    quint64 internString(QByteArray &out, const char *str) noexcept;
+
+private:
+    MC_DECL_PRIVATE(McBinaryFileAppender)
+};
+
+MC_DECL_METATYPE(McBinaryFileAppender)
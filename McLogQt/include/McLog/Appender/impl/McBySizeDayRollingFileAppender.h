@@ -42,6 +42,7 @@ public:
 
 protected:
     bool isNewNextFile() noexcept override;
+    void fileOpened(const QString &filePath) noexcept override;
 
 private:
     MC_DECL_PRIVATE(McBySizeDayRollingFileAppender)
@@ -36,6 +36,7 @@ class MCLOGQT_EXPORT McFileAppender : public McFileDeviceAppender
     Q_PROPERTY(QString dirPath READ dirPath WRITE setDirPath)
     Q_PROPERTY(QString fileNamePattern READ fileNamePattern WRITE setFileNamePattern)
     Q_PROPERTY(bool append READ isAppend WRITE setAppend)
+    Q_PROPERTY(int indexInterval READ indexInterval WRITE setIndexInterval)
 public:
     Q_INVOKABLE McFileAppender();
     ~McFileAppender() override;
@@ -49,12 +50,27 @@ public:
     bool isAppend() const noexcept;
     void setAppend(bool val) noexcept;
 
+    //! 时间索引的时间桶长度，单位毫秒，为0时不生成.idx索引文件
+    int indexInterval() const noexcept;
+    void setIndexInterval(int val) noexcept;
+
 protected:
     void doFinished() noexcept override;
+    qint64 timeIndexInterval() const noexcept override;
+    void writeTimeIndex(const QVector<McLogTimeIndex::Entry> &entries) noexcept override;
 
 protected:
     QString newFilePath() const noexcept;
     bool checkExistsFile() noexcept;
+    //! 以当前模式打开filePath，并按文件已有大小重置写入字节数
+    bool openFile(const QString &filePath) noexcept;
+    //! 打开新文件后调用，子类可在此缓存切换文件所需的信息，避免每条消息都查询文件
+    virtual void fileOpened(const QString &filePath) noexcept;
+    //! 关闭当前的时间索引文件，移动日志文件前需要先关闭
+    void closeTimeIndex() noexcept;
+
+private:
+    void openTimeIndex(const QString &filePath, bool isNewFile) noexcept;
 
 private:
     MC_DECL_PRIVATE(McFileAppender)
@@ -35,6 +35,8 @@ class MCLOGQT_EXPORT McRollingFileAppender : public McFileAppender, public IMcRe
     MC_TYPELIST(McFileAppender, IMcRequestableNextFile)
     Q_PROPERTY(QString backupDirPath READ backupDirPath WRITE setBackupDirPath)
     Q_PROPERTY(QString backupDirPattern READ backupDirPattern WRITE setBackupDirPattern)
+    Q_PROPERTY(bool compress READ compress WRITE setCompress)
+    Q_PROPERTY(QString compressRate READ compressRate WRITE setCompressRate)
 public:
     McRollingFileAppender();
     ~McRollingFileAppender() override;
@@ -45,6 +47,12 @@ public:
     QString backupDirPattern() const noexcept;
     void setBackupDirPattern(const QString &val) noexcept;
 
+    bool compress() const noexcept;
+    void setCompress(bool val) noexcept;
+
+    QString compressRate() const noexcept;
+    void setCompressRate(const QString &val) noexcept;
+
     void requestNextFile() noexcept override;
     void forceRequestNextFile() noexcept override;
 
@@ -57,7 +65,9 @@ protected:
     
 private:
     Q_INVOKABLE void nextFile() noexcept;
-    QString newBackupPath(const QString &oldFilePath) const noexcept;
+    bool lockRolling() noexcept;
+    //! 将上次运行时未来得及移动到备份目录的.rolling文件交给后台线程处理
+    void recoverRollingFiles() noexcept;
     
 private:
     MC_DECL_PRIVATE(McRollingFileAppender)
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "McAbstractAppender.h"
+
+Q_MOC_INCLUDE("McLog/Layout/IMcLayout.h")
+
+MC_FORWARD_DECL_CLASS(IMcLayout);
+
+struct McLogRecord;
+
+MC_FORWARD_DECL_PRIVATE_DATA(McSyslogAppender);
+
+/*!
+ * \brief The McSyslogAppender class
+ * 按RFC 5424格式通过UDP或Unix数据报套接字发送日志，每个数据报一条记录(RFC 5426)。
+ * 写出线程一次取出队列中的所有记录批量发送，Linux下使用sendmmsg一次系统调用发送多个数据报。
+ * 套接字为非阻塞模式，发送缓冲区已满或队列已满时直接丢弃并计入droppedCount，不会阻塞调用线程。
+ * 未设置layout时MSG部分为原始消息
+ */
+class MCLOGQT_EXPORT McSyslogAppender : public McAbstractAppender
+{
+    Q_OBJECT
+    MC_DECL_SUPER(McAbstractAppender)
+    MC_DECL_INIT(McSyslogAppender)
+    MC_TYPELIST(McAbstractAppender)
+    Q_PROPERTY(IMcLayoutPtr layout READ layout WRITE setLayout)
+    Q_PROPERTY(QString protocol READ protocol WRITE setProtocol)
+    Q_PROPERTY(QString host READ host WRITE setHost)
+    Q_PROPERTY(int port READ port WRITE setPort)
+    Q_PROPERTY(QString socketPath READ socketPath WRITE setSocketPath)
+    Q_PROPERTY(QString facility READ facility WRITE setFacility)
+    Q_PROPERTY(QString appName READ appName WRITE setAppName)
+    Q_PROPERTY(QString hostName READ hostName WRITE setHostName)
+    Q_PROPERTY(int maxDatagramSize READ maxDatagramSize WRITE setMaxDatagramSize)
+    Q_PROPERTY(int queueCapacity READ queueCapacity WRITE setQueueCapacity)
+    Q_PROPERTY(quint64 droppedCount READ droppedCount)
+public:
+    Q_INVOKABLE McSyslogAppender();
+    ~McSyslogAppender() override;
+
+    IMcLayoutPtr layout() const noexcept;
+    void setLayout(IMcLayoutConstPtrRef val) noexcept;
+
+    //! udp或unix
+    QString protocol() const noexcept;
+    void setProtocol(const QString &val) noexcept;
+
+    QString host() const noexcept;
+    void setHost(const QString &val) noexcept;
+
+    int port() const noexcept;
+    void setPort(int val) noexcept;
+
+    QString socketPath() const noexcept;
+    void setSocketPath(const QString &val) noexcept;
+
+    //! 名称(user、daemon、local0等)或0~23的数字
+    QString facility() const noexcept;
+    void setFacility(const QString &val) noexcept;
+
+    QString appName() const noexcept;
+    void setAppName(const QString &val) noexcept;
+
+    QString hostName() const noexcept;
+    void setHostName(const QString &val) noexcept;
+
+    int maxDatagramSize() const noexcept;
+    void setMaxDatagramSize(int val) noexcept;
+
+    int queueCapacity() const noexcept;
+    void setQueueCapacity(int val) noexcept;
+
+    //! 因队列已满、发送缓冲区已满或套接字不可用而丢弃的记录数
+    quint64 droppedCount() const noexcept;
+
+    void append(QtMsgType type,
+                const QMessageLogContext &context,
+                const QString &str) noexcept override;
+
+protected:
+    void doFinished() noexcept override;
+
+    void customEvent(QEvent *event) override;
+
+private:
+    void scheduleDrain() noexcept;
+    void drainQueue() noexcept;
+    int sendQueued(int maxCount) noexcept;
+    void sendDatagrams(const QVector<QByteArray> &datagrams) noexcept;
+    bool ensureSocket() noexcept;
+    void closeSocket() noexcept;
+    QByteArray buildMessage(const McLogRecord &record) noexcept;
+
+private:
+    MC_DECL_PRIVATE(McSyslogAppender)
+};
+
+MC_DECL_METATYPE(McSyslogAppender)
@@ -29,6 +29,8 @@ QT_BEGIN_NAMESPACE
 class QSettings;
 QT_END_NAMESPACE
 
+class McAbstractAppender;
+
 MC_FORWARD_DECL_CLASS(IMcLogger);
 MC_FORWARD_DECL_CLASS(IMcConfigurableAppender);
 
@@ -44,4 +46,5 @@ protected:
     void doConfigure(QSettings &settings) noexcept;
     IMcLoggerPtr configLogger(QSettings &settings) noexcept;
     QList<IMcConfigurableAppenderPtr> configAppenders(QSettings &settings) noexcept;
+    void finishAppender(McAbstractAppender *appender) noexcept;
 };
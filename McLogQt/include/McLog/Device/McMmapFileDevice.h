@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <QIODevice>
+#include "../McLogGlobal.h"
+
+MC_FORWARD_DECL_PRIVATE_DATA(McMmapFileDevice);
+
+/*!
+ * \brief The McMmapFileDevice class
+ * 按固定大小预分配并映射文件段，写入只是一次memcpy并推进尾部位置。
+ * 当前段写满时切换到后台提前创建好的下一段，写入路径上没有打开、重命名等文件操作；
+ * 写满的段在后台截断为实际长度，最后一段在close时截断，
+ * 进程崩溃残留的预分配空间在下次open时截断。
+ * 写入期间每个段持有同名的.lock锁文件，recover只处理锁文件残留且写入进程已退出的段
+ */
+class MCLOGQT_EXPORT McMmapFileDevice : public QIODevice
+{
+    Q_OBJECT
+    MC_DECL_INIT(McMmapFileDevice)
+    MC_TYPELIST();
+public:
+    Q_INVOKABLE explicit McMmapFileDevice(QObject *parent = nullptr) noexcept;
+    ~McMmapFileDevice() override;
+
+    QString dirPath() const noexcept;
+    void setDirPath(const QString &val) noexcept;
+
+    //! 与McFileAppender相同，支持%{time format}
+    QString fileNamePattern() const noexcept;
+    void setFileNamePattern(const QString &val) noexcept;
+
+    qint64 segmentSize() const noexcept;
+    void setSegmentSize(qint64 val) noexcept;
+
+    QString currentFilePath() const noexcept;
+    //! 当前段中已写入的字节数
+    qint64 tail() const noexcept;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override;
+
+    //! 将目录中因进程崩溃而残留的预分配空间截断为实际长度，不处理其他进程正在写入的段
+    static void recover(const QString &dirPath, const QString &fileNamePattern) noexcept;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    QString newFilePath() const noexcept;
+    void prepareNext() noexcept;
+    bool roll() noexcept;
+
+private:
+    MC_DECL_PRIVATE(McMmapFileDevice)
+};
+
+MC_DECL_METATYPE(McMmapFileDevice)
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "../McLogGlobal.h"
+#include "../Utils/McLogRecord.h"
 
 class IMcLayout 
 {
@@ -31,6 +32,18 @@ public:
     virtual ~IMcLayout() = default;
     
     virtual QString format(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept = 0;
+    //! 在写出线程格式化调用线程捕获的记录，默认实现使用格式化时的时间和线程
+    virtual QString formatRecord(const McLogRecord &record) noexcept
+    {
+        return format(record.type, record.context(), record.message);
+    }
+    //! 将记录按UTF-8追加到写出批次的末尾，默认实现先格式化为QString再编码
+    virtual void formatRecordUtf8(const McLogRecord &record, QByteArray &out) noexcept
+    {
+        out += formatRecord(record).toUtf8();
+    }
+    //! 是否必须在写出线程格式化。为true时appender即使未开启deferredFormat也只在调用线程捕获原始记录
+    virtual bool requiresDeferredFormat() const noexcept { return false; }
 };
 
 MC_DECL_METATYPE(IMcLayout)
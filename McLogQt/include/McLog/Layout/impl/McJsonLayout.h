@@ -0,0 +1,73 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "../IMcLayout.h"
+
+MC_FORWARD_DECL_PRIVATE_DATA(McJsonLayout);
+
+/*!
+ * \brief The McJsonLayout class
+ * 
+ * 每条日志输出为一行JSON，字段按fields的顺序输出，
+ * 可选字段为time、level、category、tid、file、line、function、message。
+ * includeMdc为true时McLogMdc中的键值对会追加为额外字段
+ */
+class MCLOGQT_EXPORT McJsonLayout : public QObject, public IMcLayout
+{
+    Q_OBJECT
+    MC_DECL_INIT(McJsonLayout)
+    MC_TYPELIST(QObject, IMcLayout)
+    Q_PROPERTY(QList<QString> fields READ fields WRITE setFields)
+    Q_PROPERTY(QString timeFormat READ timeFormat WRITE setTimeFormat)
+    Q_PROPERTY(bool includeMdc READ includeMdc WRITE setIncludeMdc)
+public:
+    Q_INVOKABLE McJsonLayout();
+    ~McJsonLayout() override;
+
+    QList<QString> fields() const noexcept;
+    void setFields(const QList<QString> &val) noexcept;
+
+    QString timeFormat() const noexcept;
+    void setTimeFormat(const QString &val) noexcept;
+
+    bool includeMdc() const noexcept;
+    void setIncludeMdc(bool val) noexcept;
+
+    QString format(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept override;
+    QString formatRecord(const McLogRecord &record) noexcept override;
+
+private:
+    QString formatJson(QtMsgType type,
+                       const QMessageLogContext &context,
+                       qint64 msecsSinceEpoch,
+                       qint64 threadId,
+                       const QString &message,
+                       const McLogMdc::Entries &mdc) const noexcept;
+
+private:
+    MC_DECL_PRIVATE(McJsonLayout)
+};
+
+MC_DECL_METATYPE(McJsonLayout)
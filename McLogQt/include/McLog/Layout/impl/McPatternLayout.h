@@ -41,6 +41,10 @@ public:
     void setPattern(const QString &val) noexcept;
     
     QString format(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept override;
+    QString formatRecord(const McLogRecord &record) noexcept override;
+    void formatRecordUtf8(const McLogRecord &record, QByteArray &out) noexcept override;
+    //! 使用%{backtrace}时为true，符号解析开销很大，只在写出线程进行
+    bool requiresDeferredFormat() const noexcept override;
     
     virtual
     Q_INVOKABLE
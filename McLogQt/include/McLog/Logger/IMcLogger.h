@@ -31,6 +31,15 @@ public:
     virtual ~IMcLogger() = default;
     
     virtual void log(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept = 0;
+    /*!
+     * \brief types
+     * 
+     * 此logger可能输出的日志类型，用于生成category过滤规则。默认接受全部类型
+     */
+    virtual QList<QtMsgType> types() const noexcept
+    {
+        return QList<QtMsgType>() << QtDebugMsg << QtInfoMsg << QtWarningMsg << QtCriticalMsg << QtFatalMsg;
+    }
 };
 
 MC_DECL_METATYPE(IMcLogger)
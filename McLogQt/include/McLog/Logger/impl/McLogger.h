@@ -56,6 +56,7 @@ public:
     void finished() noexcept;
     
     void log(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept override;
+    QList<QtMsgType> types() const noexcept override;
 
 private:
     MC_DECL_PRIVATE(McLogger)
@@ -26,6 +26,11 @@
 #include "McLogMacroGlobal.h"
 
 MC_FORWARD_DECL_CLASS(IMcLoggerRepository)
+MC_FORWARD_DECL_CLASS(IMcLogger)
+
+QT_BEGIN_NAMESPACE
+class QLoggingCategory;
+QT_END_NAMESPACE
 
 MC_FORWARD_DECL_PRIVATE_DATA(McLogManager);
 
@@ -46,11 +51,30 @@ public:
     static void uninstallQtMessageHandler() noexcept;
     static void runTask() noexcept;
     static void handlerWhenQuit(bool val) noexcept;
+    /*!
+     * \brief invalidateLoggerCache
+     * 
+     * output会按category指针在每个线程中缓存查找到的logger，
+     * 修改repository中的logger后需要调用此函数使缓存失效。
+     * 缓存持有logger的引用，被替换的logger在各线程下一次打印日志时才会释放
+     * 同时会重新计算已注册QLoggingCategory的启用类型
+     */
+    static void invalidateLoggerCache() noexcept;
 
 private:
     static void customMessageHandler(QtMsgType msgType, const QMessageLogContext &msgLogCtx, const QString &msg) noexcept;
+    /*!
+     * \brief categoryFilter
+     * 
+     * 先执行原有过滤器(setFilterRules等规则仍然生效)，
+     * 再关闭对应logger中没有任何appender接受的日志类型，使qCDebug等宏直接跳过
+     */
+    static void categoryFilter(QLoggingCategory *category) noexcept;
+    static void installCategoryFilter() noexcept;
+    static void uninstallCategoryFilter() noexcept;
     
     void output(QtMsgType msgType, const QMessageLogContext &msgLogCtx, const QString &msg) noexcept;
+    IMcLoggerPtr findLogger(IMcLoggerRepositoryConstPtrRef rep, const char *category) noexcept;
     
 private:
     MC_DECL_PRIVATE(McLogManager)
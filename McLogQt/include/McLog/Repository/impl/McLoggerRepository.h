@@ -47,6 +47,8 @@ class MCLOGQT_EXPORT McLoggerRepository
     Q_PRIVATE_PROPERTY(d, bool flushWhenQuit MEMBER flushWhenQuit)
     Q_PRIVATE_PROPERTY(d, bool waitThreadFinished MEMBER waitThreadFinished)
     Q_PRIVATE_PROPERTY(d, qint64 threadWaitTimeout MEMBER threadWaitTimeout)
+    Q_PRIVATE_PROPERTY(d, bool crashHandler MEMBER crashHandler)
+    Q_PRIVATE_PROPERTY(d, int emergencyRecords MEMBER emergencyRecords)
 public:
     Q_INVOKABLE McLoggerRepository();
     ~McLoggerRepository() override;
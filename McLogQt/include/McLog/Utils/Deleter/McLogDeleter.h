@@ -25,6 +25,7 @@
 
 #include "../../McLogGlobal.h"
 #include "../../Repository/IMcAdditionalTask.h"
+#include "../McLogFileIndex.h"
 
 MC_FORWARD_DECL_PRIVATE_DATA(McLogDeleter);
 
@@ -36,6 +37,7 @@ class MCLOGQT_EXPORT McLogDeleter : public QObject, public IMcAdditionalTask
     Q_PRIVATE_PROPERTY(d, int maxDepth MEMBER maxDepth)
     Q_PRIVATE_PROPERTY(d, QString age MEMBER age)
     Q_PRIVATE_PROPERTY(d, QList<QString> filters MEMBER filters)
+    Q_PRIVATE_PROPERTY(d, int sliceSize MEMBER sliceSize)
 public:
     Q_INVOKABLE explicit McLogDeleter(QObject *parent = nullptr) noexcept;
     ~McLogDeleter() override;
@@ -47,9 +49,8 @@ public:
     void execute() noexcept override;
 
 private:
-    void checkFiles(int depth, const QString &path) noexcept;
-    bool fileNameCheck(const QString &fileName) noexcept;
-    
+    static void deleteFiles(McLogFileIndexConstPtrRef index, qint64 cutoff, int sliceSize) noexcept;
+
 private:
     MC_DECL_PRIVATE(McLogDeleter)
 };
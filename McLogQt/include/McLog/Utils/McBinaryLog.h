@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "McLogRecord.h"
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+/*!
+ * 二进制日志文件格式：
+ * 文件头为8字节的magic加1字节版本号，之后为连续的记录。
+ * 每条记录为 varint(负载长度) + 负载，负载第一个字节为记录类型：
+ *  String：varint(id) + 字符串字节，定义category/file/function的编号，id为0表示空指针
+ *  Log：   type(1字节) + varint(categoryId) + varint(fileId) + varint(functionId)
+ *          + zigzag(line) + zigzag(与上一条的时间差) + zigzag(与上一条的单调时间差)
+ *          + zigzag(threadId) + varint(qthreadPtr) + UTF-8消息
+ * 编号和时间差均只在同一个文件内有效
+ */
+namespace McBinaryLog {
+
+constexpr char Magic[] = "MCLOGBIN";
+constexpr int MagicSize = 8;
+constexpr quint8 Version = 1;
+
+enum RecordKind : quint8 {
+    String = 1,
+    Log = 2,
+};
+
+inline void putVarint(QByteArray &out, quint64 val) noexcept
+{
+    while (val >= 0x80) {
+        out.append(static_cast<char>(val | 0x80));
+        val >>= 7;
+    }
+    out.append(static_cast<char>(val));
+}
+
+inline quint64 zigzag(qint64 val) noexcept
+{
+    return (static_cast<quint64>(val) << 1) ^ static_cast<quint64>(val >> 63);
+}
+
+inline qint64 unzigzag(quint64 val) noexcept
+{
+    return static_cast<qint64>(val >> 1) ^ -static_cast<qint64>(val & 1);
+}
+
+} // namespace McBinaryLog
+
+MC_FORWARD_DECL_PRIVATE_DATA(McBinaryLogReader);
+
+/*!
+ * \brief The McBinaryLogReader class
+ * 顺序读取McBinaryFileAppender写出的文件，读出的记录中的字符串指针在reader析构前有效
+ */
+class MCLOGQT_EXPORT McBinaryLogReader
+{
+public:
+    explicit McBinaryLogReader(QIODevice *device) noexcept;
+    ~McBinaryLogReader();
+
+    //! 读取并校验文件头，必须在readNext之前调用
+    bool readHeader() noexcept;
+    //! 读取下一条日志记录，到达文件末尾或数据损坏时返回false
+    bool readNext(McLogRecord &record) noexcept;
+
+    bool atEnd() const noexcept;
+    QString errorString() const noexcept;
+
+private:
+    bool readVarint(quint64 &val) noexcept;
+
+private:
+    Q_DISABLE_COPY(McBinaryLogReader)
+    MC_DECL_PRIVATE(McBinaryLogReader)
+};
@@ -25,8 +25,42 @@
 
 #include <QString>
 
+QT_BEGIN_NAMESPACE
+class QDateTime;
+class QFileDevice;
+QT_END_NAMESPACE
+
 class McFileUtils
 {
 public:
     static bool judgeDate(const QString &filePath, int day) noexcept;
+    //! 获取文件创建时间，不支持时使用元数据修改时间
+    static QDateTime birthTime(const QString &filePath) noexcept;
+    //! 创建于birthTime的文件在此时刻(毫秒时间戳)之后满足judgeDate，birthTime无效时返回0
+    static qint64 dateDeadline(const QDateTime &birthTime, int day) noexcept;
+    /*!
+     * \brief parseTimePattern
+     * 
+     * 将形如xxx%{time yyyy-MM-dd}xxx的模式拆分为前缀、时间格式和后缀。
+     * 不包含时间时返回false，此时前缀为整个模式
+     */
+    static bool parseTimePattern(const QString &pattern,
+                                 QString &prefix,
+                                 QString &timeFormat,
+                                 QString &suffix) noexcept;
+    //! 计算字符串按UTF-8编码后的字节数，无需实际编码，结果与appendUtf8写出的字节数一致
+    static qint64 utf8Size(QStringView str) noexcept;
+    //! 将字符串按UTF-8编码追加到out末尾，不产生临时的QByteArray。孤立的代理项编码为U+FFFD，与QString::toUtf8一致
+    static void appendUtf8(QByteArray &out, QStringView str) noexcept;
+    //! 对已打开的文件加进程间的排他建议锁(flock/LockFileEx)，阻塞直到获得锁
+    static bool lockFile(QFileDevice *file) noexcept;
+    static bool unlockFile(QFileDevice *file) noexcept;
+    //! 判断已打开的文件与filePath是否为同一个文件，filePath不存在时返回false。Windows下总是返回true
+    static bool isSameFile(QFileDevice *file, const QString &filePath) noexcept;
+    //! 将文件在操作系统中的缓存同步到磁盘，调用前需先flush
+    static bool syncFile(QFileDevice *file) noexcept;
+    //! 为文件预先分配size字节的磁盘空间，不支持时退化为resize
+    static bool preallocate(QFileDevice *file, qint64 size) noexcept;
+    //! 解析以B、KB、MB、GB为单位的大小，失败返回-1
+    static qint64 sizeFromString(const QString &val) noexcept;
 };
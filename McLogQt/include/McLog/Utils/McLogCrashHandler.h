@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "../McLogMacroGlobal.h"
+
+class McAbstractFormatAppender;
+
+/*!
+ * \brief The McLogCrashHandler class
+ * 
+ * 每个appender在调用线程把记录预先编码到自己的应急缓冲区中，并在打开设备时登记文件描述符。
+ * 进程收到SIGSEGV、SIGABRT、SIGBUS、SIGFPE、SIGILL时，把各appender尚未写出的记录用write直接写入它自己的文件，
+ * 再交还给原有的处理函数。应急缓冲区和登记表都是预先分配的定长数组，信号处理函数中不分配内存、不格式化，是异步信号安全的。
+ * 安装后各appender每批写出后都会刷新设备，已写出的记录不会滞留在QFile的缓冲区中。
+ * qFatal时由flushAll格式化并写出队列中的全部记录
+ */
+class MCLOGQT_EXPORT McLogCrashHandler
+{
+public:
+    /*!
+     * \brief install
+     * \param emergencyRecords 每个appender的应急缓冲区保存的记录条数，只在第一次安装时生效。
+     * 超过该条数还未写出的记录崩溃时只能写出最近的部分
+     */
+    static void install(int emergencyRecords = 256) noexcept;
+    static void uninstall() noexcept;
+    static bool isInstalled() noexcept;
+
+    //! 登记appender，返回其应急缓冲区的编号，登记表已满时返回-1
+    static int addAppender(McAbstractFormatAppender *appender) noexcept;
+    static void removeAppender(int target) noexcept;
+    //! 设备打开或关闭后调用，fd为-1表示当前没有可写的文件
+    static void setAppenderFd(int target, int fd, bool crlf) noexcept;
+
+    /*!
+     * \brief capture
+     * 把记录编码到target的应急缓冲区，未安装时直接返回0。只做定长拷贝，不分配内存
+     * \param isFormatted str是否已由layout格式化，为false时崩溃时写出的记录前会加上时间、分类和等级
+     * \return 记录的序号+1，写出后以此调用markWritten
+     */
+    static quint64 capture(int target,
+                           QtMsgType type,
+                           const QMessageLogContext &context,
+                           const QString &str,
+                           bool isFormatted) noexcept;
+    //! 序号+1不大于sequence的记录都已写入文件，崩溃时不再写出
+    static void markWritten(int target, quint64 sequence) noexcept;
+    //! 同步写出所有appender中尚未写出的记录，qFatal时调用。不是异步信号安全的，不能在信号处理函数中调用
+    static void flushAll() noexcept;
+
+    //! 只使用write系统调用完整写出，可以在信号处理函数中调用
+    static bool writeAll(int fd, const char *data, qsizetype size) noexcept;
+};
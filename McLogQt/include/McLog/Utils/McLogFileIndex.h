@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "../McLogGlobal.h"
+
+#include <QHash>
+#include <QMultiMap>
+#include <QMutex>
+#include <QRegularExpression>
+
+/*!
+ * \brief The McLogFileIndex class
+ * 
+ * 记录若干目录下符合过滤条件的日志文件，按最后修改时间排序。
+ * 首次使用时完整扫描一次，之后由滚动文件的appender通过fileAdded/fileRemoved增量更新，
+ * 每天再完整扫描一次以发现其他进程或手动放入的文件。
+ * 扫描和取出文件应在McLogMaintainer的线程中执行
+ */
+class McLogFileIndex
+{
+public:
+    struct Entry
+    {
+        QString filePath;
+        QString basePath;
+        qint64 lastModified{0};
+    };
+
+    McLogFileIndex(const QStringList &basePaths, int maxDepth, const QStringList &filters) noexcept;
+    ~McLogFileIndex();
+
+    //! 距离上次完整扫描超过一天时重新扫描
+    void ensureScanned() noexcept;
+    //! 取出最后修改时间早于cutoff(毫秒时间戳)的文件，最多count个
+    QList<Entry> takeExpired(qint64 cutoff, int count) noexcept;
+    /*!
+     * \brief recheckExpired
+     * 
+     * 索引中的修改时间可能已经过时，删除或打包前重新读取。
+     * 文件已不存在时返回false；取出后又被修改而不再过期时放回索引并返回false；
+     * 否则更新entry的lastModified并返回true
+     */
+    bool recheckExpired(Entry &entry, qint64 cutoff) noexcept;
+
+    //! 通知所有索引有文件新增或删除，不在其目录或不符合过滤条件的文件会被忽略
+    static void fileAdded(const QString &filePath) noexcept;
+    static void fileRemoved(const QString &filePath) noexcept;
+
+private:
+    void rescan() noexcept;
+    void scanDir(int depth, const QString &basePath, const QString &path) noexcept;
+    bool accept(const QString &filePath, QString &basePath) const noexcept;
+    bool fileNameCheck(const QString &fileName) const noexcept;
+    void insert(const QString &filePath, const QString &basePath, qint64 lastModified) noexcept;
+    void remove(const QString &filePath) noexcept;
+
+private:
+    QStringList m_basePaths;
+    int m_maxDepth{1};
+    QList<QRegularExpression> m_filters; //!< 预先编译的文件名过滤条件
+    mutable QMutex m_mutex;
+    QMultiMap<qint64, Entry> m_entries; //!< key为最后修改时间
+    QHash<QString, qint64> m_lastModified;
+    qint64 m_lastScanTime{0};
+};
+
+MC_DECL_POINTER(McLogFileIndex)
@@ -0,0 +1,51 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <functional>
+
+#include "../McLogMacroGlobal.h"
+
+/*!
+ * \brief The McLogMaintainer class
+ * 
+ * 在单个低优先级后台线程中按投递顺序执行文件重命名、备份等维护任务，
+ * 使写日志线程切换文件时不必等待这些操作
+ */
+class MCLOGQT_EXPORT McLogMaintainer
+{
+public:
+    static void post(const std::function<void()> &task) noexcept;
+    //! 等待已投递的任务全部完成，msecs为-1时一直等待
+    static bool waitForDone(int msecs = -1) noexcept;
+    /*!
+     * \brief shutdown
+     * 
+     * 进程退出时调用。之后压缩、打包等耗时任务会被跳过，正在进行的压缩尽快中止，
+     * 重命名等快速任务仍会执行，最多等待msecs毫秒
+     */
+    static bool shutdown(int msecs) noexcept;
+    //! shutdown后为true，耗时任务开始前和执行期间应检查此标志
+    static bool isShuttingDown() noexcept;
+};
@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "../McLogGlobal.h"
+
+#include <QPair>
+
+/*!
+ * \brief The McLogMdc class
+ * 
+ * 当前线程的诊断上下文(Mapped Diagnostic Context)，保存的键值对会被McJsonLayout输出为额外字段。
+ * deferredFormat为true时，日志记录会在调用线程中捕获当时的键值对
+ */
+class MCLOGQT_EXPORT McLogMdc
+{
+public:
+    using Entries = QList<QPair<QString, QString>>;
+
+    static void put(const QString &key, const QString &value) noexcept;
+    static void remove(const QString &key) noexcept;
+    static void clear() noexcept;
+    static Entries entries() noexcept;
+};
+
+//! 构造时放入键值对，析构时移除
+class MCLOGQT_EXPORT McLogMdcScope
+{
+    Q_DISABLE_COPY(McLogMdcScope)
+public:
+    McLogMdcScope(const QString &key, const QString &value) noexcept;
+    ~McLogMdcScope();
+
+private:
+    QString m_key;
+};
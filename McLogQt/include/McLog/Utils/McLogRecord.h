@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "../McLogGlobal.h"
+#include "McLogMdc.h"
+
+#include <QVector>
+
+/*!
+ * \brief The McLogRecord struct
+ * 调用线程捕获的原始日志记录，格式化工作留到写出线程完成。
+ * capture时category/file/function会被拷贝到contextStrings中，QML等来源的临时字符串在记录写出前可能已被释放
+ */
+struct MCLOGQT_EXPORT McLogRecord
+{
+    QtMsgType type{QtDebugMsg};
+    int line{0};
+    const char *category{nullptr};
+    const char *file{nullptr};
+    const char *function{nullptr};
+    qint64 msecsSinceEpoch{0}; //!< 记录产生时的时间
+    qint64 monotonicMsecs{0};  //!< 记录产生时单调时钟的毫秒数，用于%{time process}和%{time boot}
+    qint64 threadId{0};
+    quintptr qthreadPtr{0};
+    QString message;           //!< 原始消息，isFormatted为true时为格式化后的消息
+    McLogMdc::Entries mdc;     //!< 调用线程当时的诊断上下文
+    QVector<void *> backtrace; //!< %{backtrace}所需的原始帧地址，符号在格式化时才解析
+    bool isFormatted{false};
+    quint64 crashSequence{0};  //!< 在appender应急缓冲区中的序号+1，0表示未记录
+    //! category/file/function指向的存储，隐式共享，记录拷贝或移动后指针依然有效，不要修改
+    QByteArray contextStrings;
+
+    static McLogRecord capture(QtMsgType type,
+                               const QMessageLogContext &context,
+                               const QString &str) noexcept;
+
+    QMessageLogContext context() const noexcept
+    {
+        return QMessageLogContext(file, line, function, category);
+    }
+};
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include "../McLogGlobal.h"
+
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+/*!
+ * 时间索引文件格式(与日志文件同名，后缀为.idx)：
+ * 文件头为6字节的magic加1字节版本号、1字节保留，以及8字节小端的时间桶长度(毫秒)。
+ * 之后为连续的16字节条目：8字节小端的时间桶起点(毫秒时间戳) + 8字节小端的偏移量，
+ * 偏移量为该时间桶中第一条记录在未压缩日志文件中的字节位置，条目按偏移量递增
+ */
+namespace McLogTimeIndex {
+
+constexpr char Magic[] = "MCTIDX";
+constexpr int MagicSize = 6;
+constexpr quint8 Version = 1;
+constexpr int HeaderSize = 16;
+constexpr int EntrySize = 16;
+
+struct Entry
+{
+    qint64 msecsSinceEpoch{0};
+    qint64 offset{0};
+};
+
+//! 日志文件对应的索引文件路径，压缩后的.gz文件与压缩前共用同一个索引
+MCLOGQT_EXPORT QString indexPath(const QString &logPath) noexcept;
+
+MCLOGQT_EXPORT QByteArray header(qint64 interval) noexcept;
+MCLOGQT_EXPORT void appendEntry(QByteArray &out, const Entry &entry) noexcept;
+
+//! 读取索引文件，进程异常退出时末尾不完整的条目会被忽略
+MCLOGQT_EXPORT bool read(const QString &indexPath, qint64 &interval, QVector<Entry> &entries) noexcept;
+
+/*!
+ * \brief copyRange
+ * 
+ * 根据索引把日志文件中[from, to]时间范围内的数据写入out，时间为毫秒时间戳。
+ * 范围按时间桶对齐，两端可能多出不超过一个时间桶的记录。
+ * .gz文件会流式解压。没有可用的索引时返回false，不写出任何数据
+ */
+MCLOGQT_EXPORT bool copyRange(const QString &logPath, qint64 from, qint64 to, QIODevice *out) noexcept;
+
+} // namespace McLogTimeIndex
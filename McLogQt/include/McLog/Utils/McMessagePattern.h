@@ -23,10 +23,21 @@
  */
 #pragma once
 
+#include <QAtomicInt>
 #include <QElapsedTimer>
+#include <QVector>
 
 #include "../McLogGlobal.h"
 
+// same condition as Qt's own qlogging.cpp, which does not export the macro
+#if !defined(QT_BOOTSTRAPPED) && !defined(QLOGGING_HAVE_BACKTRACE) && QT_CONFIG(regularexpression)
+#  if defined(__GLIBC__) && __has_include(<cxxabi.h>) && __has_include(<execinfo.h>)
+#    define QLOGGING_HAVE_BACKTRACE
+#  endif
+#endif
+
+struct McLogRecord;
+
 namespace McPrivate {
 
 struct McMessagePattern 
@@ -36,10 +47,51 @@ struct McMessagePattern
 
     void setPattern(const QString &pattern);
 
+    // one step of the compiled pattern, executed in sequence by format()
+    struct Emitter
+    {
+        enum Kind {
+            Literal,
+            Message,
+            Category,
+            Type,
+            File,
+            Line,
+            Function,
+            Pid,
+            AppName,
+            ThreadId,
+            QThreadPtr,
+            Backtrace,
+            TimeProcess,
+            TimeBoot,
+            TimeIso,    // formatted once per second
+            TimeCached, // formatted once per second, milliseconds patched per message
+            TimeFormat, // formatted per message
+            IfCategory,
+            IfDebug,
+            IfInfo,
+            IfWarning,
+            IfCritical,
+            IfFatal,
+            Endif
+        };
+        Kind kind{Literal};
+        QString text;         // literal text or time format
+        QByteArray utf8Text;  // literal text encoded for formatUtf8()
+        QString cachedFormat; // time format with every "zzz" replaced by a quoted marker
+        int msCount{0};       // number of "zzz" in the time format
+        int argIndex{-1};     // index of backtraceArgs
+        int skipTo{-1};       // for %{if-*}: index of the matching %{endif}
+    };
+
     // 0 terminated arrays of literal tokens / literal or placeholder tokens
     const char **literals;
     const char **tokens;
     QList<QString> timeArgs;   // timeFormats in sequence of %{time
+    QVector<Emitter> emitters;
+    quint64 id{0};             // distinguishes the caches of different patterns
+    QAtomicInt reserveSize{0}; // length of the last output without the message
 #ifndef QT_BOOTSTRAPPED
     QElapsedTimer timer;
 #endif
@@ -58,5 +110,15 @@ Q_DECLARE_TYPEINFO(McMessagePattern::BacktraceParams, Q_MOVABLE_TYPE);
 #endif
 
 QString format(McMessagePatternPtr pattern, QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept;
+// formats with the time and thread captured in the record instead of the current ones
+QString format(McMessagePatternPtr pattern, const McLogRecord &record) noexcept;
+// same as above, appended to out as UTF-8 without building the UTF-16 text first
+void formatUtf8(McMessagePatternPtr pattern, const McLogRecord &record, QByteArray &out) noexcept;
+
+// the id printed by %{threadid}, cached per thread
+qint64 currentThreadId() noexcept;
+
+// raw return addresses for %{backtrace}, empty if no pattern uses it; symbolized when formatting
+QVector<void *> captureBacktrace() noexcept;
 
 }
@@ -0,0 +1,176 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <QWaitCondition>
+
+/*!
+ * \brief The McMpscRingBuffer class
+ * 有界的多生产者单消费者环形队列(Vyukov算法)。
+ * 生产者之间只通过一次CAS竞争写入位置，不加锁；消费者只能有一个。
+ * 队列已满时生产者可以在waitForSpace中挂起，消费者每取出一批后唤醒，没有等待者时不加锁
+ */
+template<typename T>
+class McMpscRingBuffer
+{
+    Q_DISABLE_COPY(McMpscRingBuffer)
+public:
+    //! 容量会向上取整为2的幂
+    explicit McMpscRingBuffer(int capacity) noexcept
+    {
+        quint64 size = 2;
+        while (size < static_cast<quint64>(qMax(2, capacity))) {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (quint64 i = 0; i < size; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    int capacity() const noexcept { return static_cast<int>(m_mask + 1); }
+
+    bool tryPush(const T &val) noexcept
+    {
+        T tmp = val;
+        return tryPush(std::move(tmp));
+    }
+    bool tryPush(T &&val) noexcept
+    {
+        auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        forever {
+            cell = &m_cells[pos & m_mask];
+            auto seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<qint64>(seq) - static_cast<qint64>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; //!< 队列已满
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(val);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! 只能在消费者线程调用
+    bool tryPop(T &val) noexcept
+    {
+        auto &cell = m_cells[m_dequeuePos & m_mask];
+        auto seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<qint64>(seq) - static_cast<qint64>(m_dequeuePos + 1) < 0) {
+            return false;
+        }
+        val = std::move(cell.data);
+        cell.data = T();
+        cell.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+        ++m_dequeuePos;
+        return true;
+    }
+
+    //! 只能在消费者线程调用，最多取出maxCount个元素，返回实际取出的个数。取出后唤醒等待空间的生产者
+    template<typename Func>
+    int drain(Func func, int maxCount) noexcept
+    {
+        int count = 0;
+        T val;
+        while (count < maxCount && tryPop(val)) {
+            func(val);
+            ++count;
+        }
+        if (count > 0) {
+            notifySpace();
+        }
+        return count;
+    }
+
+    //! 任意线程调用，队列已满时返回true
+    bool isFull() const noexcept
+    {
+        auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+        const auto &cell = m_cells[pos & m_mask];
+        return static_cast<qint64>(cell.sequence.load(std::memory_order_acquire))
+                   - static_cast<qint64>(pos)
+               < 0;
+    }
+
+    //! 生产者调用，队列已满时挂起直到消费者取出元素或deadline到期，超时返回false
+    bool waitForSpace(QDeadlineTimer deadline) noexcept
+    {
+        QMutexLocker locker(&m_spaceMtx);
+        m_spaceWaiters.fetch_add(1, std::memory_order_relaxed);
+        //! 与notifySpace中的屏障配对：先登记等待者再检查队列，消费者要么看到等待者，要么本线程看到空位
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ret = true;
+        if (isFull()) {
+            ret = m_spaceCond.wait(&m_spaceMtx, deadline);
+        }
+        m_spaceWaiters.fetch_sub(1, std::memory_order_relaxed);
+        return ret;
+    }
+
+    //! 消费者调用，唤醒所有在waitForSpace中挂起的生产者
+    void notifySpace() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_spaceWaiters.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        QMutexLocker locker(&m_spaceMtx);
+        m_spaceCond.wakeAll();
+    }
+
+    //! 只能在消费者线程调用，已占位但尚未写完的元素视为不存在
+    bool isEmpty() const noexcept
+    {
+        const auto &cell = m_cells[m_dequeuePos & m_mask];
+        return cell.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<quint64> sequence{0};
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    quint64 m_mask{0};
+    alignas(64) std::atomic<quint64> m_enqueuePos{0};
+    alignas(64) quint64 m_dequeuePos{0};
+    alignas(64) std::atomic<int> m_spaceWaiters{0};
+    QMutex m_spaceMtx;
+    QWaitCondition m_spaceCond;
+};
@@ -25,6 +25,7 @@
 
 #include "../../McLogGlobal.h"
 #include "../../Repository/IMcAdditionalTask.h"
+#include "../McLogFileIndex.h"
 
 MC_FORWARD_DECL_PRIVATE_DATA(McLogPackager);
 
@@ -38,6 +39,7 @@ class MCLOGQT_EXPORT McLogPackager : public QObject, public IMcAdditionalTask
     Q_PRIVATE_PROPERTY(d, QList<QString> filters MEMBER filters)
     Q_PRIVATE_PROPERTY(d, QString dstPath MEMBER dstPath)
     Q_PRIVATE_PROPERTY(d, QString fileNamePattern MEMBER fileNamePattern)
+    Q_PRIVATE_PROPERTY(d, int sliceSize MEMBER sliceSize)
 public:
     Q_INVOKABLE McLogPackager() noexcept;
     ~McLogPackager();
@@ -49,9 +51,12 @@ public:
     void execute() noexcept override;
 
 private:
-    QStringList checkFiles(int depth, const QString &path) noexcept;
-    bool fileNameCheck(const QString &fileName) noexcept;
-    QString newFilePath() const noexcept;
+    struct Target;
+    static void packFiles(McLogFileIndexConstPtrRef index,
+                          const QSharedPointer<Target> &target,
+                          qint64 cutoff,
+                          int sliceSize) noexcept;
+    static QString newFilePath(const Target &target) noexcept;
 
 private:
     MC_DECL_PRIVATE(McLogPackager)
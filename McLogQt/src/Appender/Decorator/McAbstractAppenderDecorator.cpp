@@ -78,7 +78,16 @@ void McAbstractAppenderDecorator::setThreshold(const QString &val) noexcept
 
 QList<QtMsgType> McAbstractAppenderDecorator::types() const noexcept
 {
-    return QList<QtMsgType>();
+    //! 装饰器本身不过滤，可接受的类型为所有被装饰appender的并集
+    QList<QtMsgType> types;
+    for (auto appender : d->appenders) {
+        for (auto type : appender->types()) {
+            if (!types.contains(type)) {
+                types.append(type);
+            }
+        }
+    }
+    return types;
 }
 
 QList<IMcConfigurableAppenderPtr> McAbstractAppenderDecorator::appenders() const noexcept
@@ -100,6 +109,9 @@ void McAbstractAppenderDecorator::append(QtMsgType type, const QMessageLogContex
 
 void McAbstractAppenderDecorator::finished() noexcept
 {
+    if (separator().isNull() || !separator()->isAutoSeparate) {
+        return;
+    }
     //! 回归到本类线程中执行
     connect(&d->autoSeparateTimer, &QTimer::timeout, this, [this](){
         QMessageLogContext context(QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE, QT_MESSAGELOG_FUNC, nullptr);
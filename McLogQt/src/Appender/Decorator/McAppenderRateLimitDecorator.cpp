@@ -0,0 +1,319 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Appender/Decorator/McAppenderRateLimitDecorator.h"
+
+#include <array>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+
+MC_INIT(McAppenderRateLimitDecorator)
+MC_REGISTER_BEAN_FACTORY(McAppenderRateLimitDecorator)
+MC_INIT_END
+
+namespace {
+
+constexpr int kSlotCount = 1024;
+constexpr int kStripeCount = 32;
+constexpr int kMaxBuckets = 1024;
+
+//! 一个调用位置的一条消息在当前窗口内的状态
+struct McDedupSlot
+{
+    size_t key{0};
+    qint64 windowStart{0};
+    int repeated{0};
+    QtMsgType type{QtDebugMsg};
+    //! 汇总在窗口结束后才输出，此时QML等来源的临时字符串可能已被释放，都需要复制
+    QByteArray file;
+    QByteArray function;
+    int line{0};
+    QByteArray category;
+    QString message;
+};
+
+struct McRateBucket
+{
+    double tokens{0};
+    qint64 lastRefill{0};
+    int dropped{0};
+    QByteArray category;
+};
+
+struct McRepeatSummary
+{
+    int repeated{0};
+    QtMsgType type{QtDebugMsg};
+    QByteArray file;
+    QByteArray function;
+    int line{0};
+    QByteArray category;
+    QString message;
+};
+
+McRepeatSummary takeSummary(McDedupSlot &slot) noexcept
+{
+    McRepeatSummary summary;
+    summary.repeated = slot.repeated;
+    summary.type = slot.type;
+    summary.file = slot.file;
+    summary.function = slot.function;
+    summary.line = slot.line;
+    summary.category = slot.category;
+    summary.message = slot.message;
+    slot.repeated = 0;
+    return summary;
+}
+
+//! 只包装指针，不复制
+QByteArray rawBytes(const char *str) noexcept
+{
+    return str == nullptr ? QByteArray() : QByteArray::fromRawData(str, static_cast<int>(qstrlen(str)));
+}
+
+//! 保留空指针与空字符串的区别
+QByteArray copyBytes(const char *str) noexcept
+{
+    return str == nullptr ? QByteArray() : QByteArray(str);
+}
+
+const char *constData(const QByteArray &bytes) noexcept
+{
+    return bytes.isNull() ? nullptr : bytes.constData();
+}
+
+} // namespace
+
+MC_DECL_PRIVATE_DATA(McAppenderRateLimitDecorator)
+int dedupWindow{1000}; //!< 单位：ms，小于等于0时不去重
+int rateLimit{0};      //!< 每个category每秒最多输出的消息数，小于等于0时不限制
+int burst{0};          //!< 令牌桶容量，小于等于0时等于rateLimit
+QElapsedTimer clock;
+std::array<McDedupSlot, kSlotCount> slots;
+std::array<QMutex, kStripeCount> stripes; //!< 分段加锁，不同调用位置的消息很少竞争同一把锁
+QMutex bucketMutex;
+QHash<QByteArray, McRateBucket> buckets; //!< 按内容区分category，临时QLoggingCategory的名字指针可能被复用
+QTimer summaryTimer;
+MC_DECL_PRIVATE_DATA_END
+
+McAppenderRateLimitDecorator::McAppenderRateLimitDecorator(QObject *parent)
+    : McAbstractAppenderDecorator(parent)
+{
+    MC_NEW_PRIVATE_DATA(McAppenderRateLimitDecorator);
+
+    d->clock.start();
+}
+
+McAppenderRateLimitDecorator::~McAppenderRateLimitDecorator()
+{
+}
+
+int McAppenderRateLimitDecorator::dedupWindow() const noexcept
+{
+    return d->dedupWindow;
+}
+
+void McAppenderRateLimitDecorator::setDedupWindow(int val) noexcept
+{
+    d->dedupWindow = val;
+}
+
+int McAppenderRateLimitDecorator::rateLimit() const noexcept
+{
+    return d->rateLimit;
+}
+
+void McAppenderRateLimitDecorator::setRateLimit(int val) noexcept
+{
+    d->rateLimit = val;
+}
+
+int McAppenderRateLimitDecorator::burst() const noexcept
+{
+    return d->burst;
+}
+
+void McAppenderRateLimitDecorator::setBurst(int val) noexcept
+{
+    d->burst = val;
+}
+
+void McAppenderRateLimitDecorator::append(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept
+{
+    if (type != QtFatalMsg) {
+        if (d->dedupWindow > 0 && isDuplicate(type, context, str)) {
+            return;
+        }
+        if (d->rateLimit > 0 && !tryAcquire(context)) {
+            return;
+        }
+    }
+    McAbstractAppenderDecorator::append(type, context, str);
+}
+
+void McAppenderRateLimitDecorator::finished() noexcept
+{
+    McAbstractAppenderDecorator::finished();
+
+    if (d->dedupWindow <= 0 && d->rateLimit <= 0) {
+        return;
+    }
+    //! 回归到本类线程中执行
+    connect(&d->summaryTimer, &QTimer::timeout, this, [this]() { flushSummaries(); }, Qt::QueuedConnection);
+    d->summaryTimer.start(d->dedupWindow > 0 ? d->dedupWindow : 1000);
+}
+
+void McAppenderRateLimitDecorator::doAppend(IMcConfigurableAppenderConstPtrRef appender, QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept
+{
+    appender->append(type, context, str);
+}
+
+bool McAppenderRateLimitDecorator::isDuplicate(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept
+{
+    //! qHashMulti只在Qt6中提供，这里逐个组合
+    auto file = rawBytes(context.file);
+    size_t key = qHash(str, qHash(context.line, qHash(file)));
+    if (key == 0) {
+        key = 1; //!< 0表示空槽位
+    }
+    auto index = key % kSlotCount;
+    auto now = d->clock.elapsed();
+    McRepeatSummary summary;
+    {
+        QMutexLocker locker(&d->stripes[index % kStripeCount]);
+        auto &slot = d->slots[index];
+        //! 哈希相同时还要比较内容，避免不同的消息被当作重复丢弃
+        if (slot.key == key && now - slot.windowStart < d->dedupWindow && slot.line == context.line
+            && slot.message == str && slot.file == file) {
+            ++slot.repeated;
+            return true;
+        }
+        //! 窗口已结束或槽位被其他消息占用，先取出尚未汇总的重复次数
+        if (slot.repeated > 0) {
+            summary = takeSummary(slot);
+        }
+        slot.key = key;
+        slot.windowStart = now;
+        slot.type = type;
+        slot.file = copyBytes(context.file);
+        slot.function = copyBytes(context.function);
+        slot.line = context.line;
+        slot.category = copyBytes(context.category);
+        slot.message = str;
+    }
+    if (summary.repeated > 0) {
+        appendSummary(summary.type,
+                      summary.file,
+                      summary.line,
+                      summary.function,
+                      summary.category,
+                      summary.message + QStringLiteral(" (repeated ") + QString::number(summary.repeated)
+                          + QStringLiteral(" times)"));
+    }
+    return false;
+}
+
+bool McAppenderRateLimitDecorator::tryAcquire(const QMessageLogContext &context) noexcept
+{
+    auto capacity = static_cast<double>(d->burst > 0 ? d->burst : d->rateLimit);
+    auto now = d->clock.elapsed();
+    QMutexLocker locker(&d->bucketMutex);
+    auto category = rawBytes(context.category);
+    auto itr = d->buckets.find(category);
+    if (itr == d->buckets.end()) {
+        //! 动态创建的category过多时直接清空，只会丢失尚未汇总的丢弃计数
+        if (d->buckets.size() >= kMaxBuckets) {
+            d->buckets.clear();
+        }
+        McRateBucket bucket;
+        bucket.tokens = capacity;
+        bucket.lastRefill = now;
+        bucket.category = copyBytes(context.category);
+        itr = d->buckets.insert(bucket.category, bucket);
+    }
+    itr->tokens = qMin(capacity, itr->tokens + (now - itr->lastRefill) * d->rateLimit / 1000.0);
+    itr->lastRefill = now;
+    if (itr->tokens < 1) {
+        ++itr->dropped;
+        return false;
+    }
+    itr->tokens -= 1;
+    return true;
+}
+
+void McAppenderRateLimitDecorator::flushSummaries() noexcept
+{
+    auto now = d->clock.elapsed();
+    for (int i = 0; i < kSlotCount; ++i) {
+        McRepeatSummary summary;
+        {
+            QMutexLocker locker(&d->stripes[i % kStripeCount]);
+            auto &slot = d->slots[i];
+            if (slot.repeated == 0 || now - slot.windowStart < d->dedupWindow) {
+                continue;
+            }
+            summary = takeSummary(slot);
+        }
+        appendSummary(summary.type,
+                      summary.file,
+                      summary.line,
+                      summary.function,
+                      summary.category,
+                      summary.message + QStringLiteral(" (repeated ") + QString::number(summary.repeated)
+                          + QStringLiteral(" times)"));
+    }
+
+    QList<QPair<QByteArray, int>> dropped;
+    {
+        QMutexLocker locker(&d->bucketMutex);
+        for (auto &bucket : d->buckets) {
+            if (bucket.dropped == 0) {
+                continue;
+            }
+            dropped.append(qMakePair(bucket.category, bucket.dropped));
+            bucket.dropped = 0;
+        }
+    }
+    for (auto &pair : qAsConst(dropped)) {
+        appendSummary(QtWarningMsg,
+                      QByteArray(),
+                      0,
+                      QByteArray(),
+                      pair.first,
+                      QStringLiteral("rate limit dropped %1 messages").arg(pair.second));
+    }
+}
+
+void McAppenderRateLimitDecorator::appendSummary(QtMsgType type,
+                                                 const QByteArray &file,
+                                                 int line,
+                                                 const QByteArray &function,
+                                                 const QByteArray &category,
+                                                 const QString &message) noexcept
+{
+    QMessageLogContext context(constData(file), line, constData(function), constData(category));
+    McAbstractAppenderDecorator::append(type, context, message);
+}
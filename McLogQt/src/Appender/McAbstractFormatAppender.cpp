@@ -23,13 +23,116 @@
  */
 #include "McLog/Appender/impl/McAbstractFormatAppender.h"
 
+#include <atomic>
+
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileDevice>
 #include <QLockFile>
 #include <QScopeGuard>
 #include <QThread>
+#include <QTimer>
 #include <qlogging.h>
 
 #include "McLog/Layout/impl/McNormalLayout.h"
+#include "McLog/Utils/McFileUtils.h"
+#include "McLog/Utils/McLogCrashHandler.h"
+#include "McLog/Utils/McLogRecord.h"
+#include "McLog/Utils/McRingBuffer.h"
+
+namespace {
+
+enum class Durability {
+    None,  //!< 只交给设备缓冲，由缓冲区写满或设备关闭时写出
+    Flush, //!< 每批消息写出后flush一次
+    Fsync  //!< 每批消息写出后flush，且最多每fsyncInterval毫秒同步一次磁盘
+};
+
+enum class OverflowPolicy {
+    Block,      //!< 等待消费者，最多等待blockTimeout毫秒
+    DropNewest, //!< 直接丢弃新消息
+    DropBelow,  //!< 丢弃低于dropThreshold的消息
+    Sample      //!< 每sampleRate条保留一条
+};
+
+//! 按严重程度排序，QtMsgType的枚举值本身不是有序的
+int severityRank(QtMsgType type) noexcept
+{
+    switch (type) {
+    case QtDebugMsg:
+        return 0;
+    case QtInfoMsg:
+        return 1;
+    case QtWarningMsg:
+        return 2;
+    case QtCriticalMsg:
+        return 3;
+    case QtFatalMsg:
+        return 4;
+    }
+    return 0;
+}
+
+int severityRank(const QString &level) noexcept
+{
+    auto val = level.trimmed().toLower();
+    if (val == "debug") {
+        return 0;
+    } else if (val == "info") {
+        return 1;
+    } else if (val == "warn" || val == "warning") {
+        return 2;
+    } else if (val == "critical") {
+        return 3;
+    } else if (val == "fatal") {
+        return 4;
+    }
+    MC_PRINT_ERR("unknown level: %s. use warn\n", qPrintable(level));
+    return 2;
+}
+
+//! 配置完成之前投递给写出线程的原始记录，在写出线程格式化
+class McRecordEvent : public QEvent
+{
+public:
+    explicit McRecordEvent(McLogRecord &&record) noexcept
+        : QEvent(static_cast<QEvent::Type>(QEvent::User + 2))
+        , record(std::move(record))
+    {
+    }
+
+    McLogRecord record;
+};
+
+//! 标记当前线程正在写设备，与崩溃时的emergencyFlush互斥，同一线程可以重入
+class McWriteScope
+{
+public:
+    explicit McWriteScope(std::atomic<Qt::HANDLE> &owner) noexcept
+        : m_owner(owner)
+    {
+        Qt::HANDLE expected = nullptr;
+        auto current = QThread::currentThreadId();
+        m_isOwner = m_owner.compare_exchange_strong(expected, current, std::memory_order_acquire);
+        m_isAcquired = m_isOwner || expected == current;
+    }
+    ~McWriteScope()
+    {
+        if (m_isOwner) {
+            m_owner.store(nullptr, std::memory_order_release);
+        }
+    }
+
+    bool isAcquired() const noexcept { return m_isAcquired; }
+
+private:
+    std::atomic<Qt::HANDLE> &m_owner;
+    bool m_isOwner{false};
+    bool m_isAcquired{false};
+};
+
+} // namespace
 
 MC_DECL_PRIVATE_DATA(McAbstractFormatAppender)
 IMcLayoutPtr layout;
@@ -38,6 +141,36 @@ bool useLockFile{false}; //!< 是否使用文件锁，如果程序允许同时
 bool isPrintError{true}; //!< 是否打印因没有定义QT_MESSAGELOGCONTEXT宏导致的错误消息
 QString lockFilePath{"./.mcLogQt/~.lockFile"};
 QScopedPointer<QLockFile> lockFile;
+int queueCapacity{8192}; //!< 待写入消息队列的容量，会向上取整为2的幂
+QScopedPointer<McMpscRingBuffer<McLogRecord>> queue;
+QAtomicInteger<bool> isDrainScheduled{false};
+QString durability{"none"}; //!< 持久化策略，可选none/flush/fsync
+int fsyncInterval{1000};    //!< durability为fsync时两次同步磁盘的最小间隔，单位毫秒
+Durability durabilityMode{Durability::None};
+QElapsedTimer lastSyncTimer;
+bool isSyncScheduled{false};
+bool deferredFormat{false}; //!< 是否在写出线程格式化，调用线程只捕获原始记录
+qint64 bytesWritten{0};
+bool multiProcess{false}; //!< 多进程共享文件时以O_APPEND打开，每批消息直接write，不再使用lockFile
+int atomicWriteSize{65536}; //!< 多进程模式下单次write的上限，不超过此大小的消息不会与其他进程交错
+std::atomic<Qt::HANDLE> writingThread{nullptr}; //!< 正在写设备的线程
+int crashTarget{-1}; //!< 在McLogCrashHandler中的编号
+QString overflowPolicy{"block"};
+OverflowPolicy overflowMode{OverflowPolicy::Block};
+int blockTimeout{-1};
+QString dropThreshold{"warn"};
+int dropThresholdRank{2};
+int sampleRate{10};
+std::atomic<quint64> sampleCounter{0};
+int statsInterval{0};
+QElapsedTimer lastStatsTimer;
+std::atomic<quint64> enqueuedCount{0};
+std::atomic<quint64> droppedCount{0};
+std::atomic<qint64> blockedNsecs{0};
+quint64 lastStatsEnqueued{0};
+quint64 lastStatsDropped{0};
+qint64 timeIndexInterval{0}; //!< 为0时不记录时间索引
+qint64 batchOffset{0};       //!< 当前批次写出前设备中已有的字节数
 MC_DECL_PRIVATE_DATA_END
 
 MC_INIT(McAbstractFormatAppender)
@@ -50,6 +183,7 @@ McAbstractFormatAppender::McAbstractFormatAppender()
 
 McAbstractFormatAppender::~McAbstractFormatAppender() 
 {
+    McLogCrashHandler::removeAppender(d->crashTarget);
 }
 
 IMcLayoutPtr McAbstractFormatAppender::layout() const noexcept 
@@ -102,6 +236,132 @@ void McAbstractFormatAppender::setLockFilePath(const QString &val) noexcept
     d->lockFilePath = val;
 }
 
+int McAbstractFormatAppender::queueCapacity() const noexcept
+{
+    return d->queueCapacity;
+}
+
+void McAbstractFormatAppender::setQueueCapacity(int val) noexcept
+{
+    d->queueCapacity = val;
+}
+
+QString McAbstractFormatAppender::durability() const noexcept
+{
+    return d->durability;
+}
+
+void McAbstractFormatAppender::setDurability(const QString &val) noexcept
+{
+    d->durability = val;
+}
+
+int McAbstractFormatAppender::fsyncInterval() const noexcept
+{
+    return d->fsyncInterval;
+}
+
+void McAbstractFormatAppender::setFsyncInterval(int val) noexcept
+{
+    d->fsyncInterval = val;
+}
+
+bool McAbstractFormatAppender::deferredFormat() const noexcept
+{
+    return d->deferredFormat;
+}
+
+void McAbstractFormatAppender::setDeferredFormat(bool val) noexcept
+{
+    d->deferredFormat = val;
+}
+
+bool McAbstractFormatAppender::multiProcess() const noexcept
+{
+    return d->multiProcess;
+}
+
+void McAbstractFormatAppender::setMultiProcess(bool val) noexcept
+{
+    d->multiProcess = val;
+}
+
+int McAbstractFormatAppender::atomicWriteSize() const noexcept
+{
+    return d->atomicWriteSize;
+}
+
+void McAbstractFormatAppender::setAtomicWriteSize(int val) noexcept
+{
+    d->atomicWriteSize = val;
+}
+
+QString McAbstractFormatAppender::overflowPolicy() const noexcept
+{
+    return d->overflowPolicy;
+}
+
+void McAbstractFormatAppender::setOverflowPolicy(const QString &val) noexcept
+{
+    d->overflowPolicy = val;
+}
+
+int McAbstractFormatAppender::blockTimeout() const noexcept
+{
+    return d->blockTimeout;
+}
+
+void McAbstractFormatAppender::setBlockTimeout(int val) noexcept
+{
+    d->blockTimeout = val;
+}
+
+QString McAbstractFormatAppender::dropThreshold() const noexcept
+{
+    return d->dropThreshold;
+}
+
+void McAbstractFormatAppender::setDropThreshold(const QString &val) noexcept
+{
+    d->dropThreshold = val;
+    d->dropThresholdRank = severityRank(val);
+}
+
+int McAbstractFormatAppender::sampleRate() const noexcept
+{
+    return d->sampleRate;
+}
+
+void McAbstractFormatAppender::setSampleRate(int val) noexcept
+{
+    d->sampleRate = qMax(1, val);
+}
+
+int McAbstractFormatAppender::statsInterval() const noexcept
+{
+    return d->statsInterval;
+}
+
+void McAbstractFormatAppender::setStatsInterval(int val) noexcept
+{
+    d->statsInterval = val;
+}
+
+quint64 McAbstractFormatAppender::enqueuedCount() const noexcept
+{
+    return d->enqueuedCount.load(std::memory_order_relaxed);
+}
+
+quint64 McAbstractFormatAppender::droppedCount() const noexcept
+{
+    return d->droppedCount.load(std::memory_order_relaxed);
+}
+
+qint64 McAbstractFormatAppender::blockedMsecs() const noexcept
+{
+    return d->blockedNsecs.load(std::memory_order_relaxed) / 1000000;
+}
+
 void McAbstractFormatAppender::append(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept 
 {
     if(!types().contains(type)) {
@@ -118,10 +378,33 @@ void McAbstractFormatAppender::append(QtMsgType type, const QMessageLogContext &
         && d->isPrintError) {
         MC_PRINT_ERR("in release, need to manual define QT_MESSAGELOGCONTEXT\n");
     }
+    //! layout要求时（如%{backtrace}）也只捕获原始记录，避免在调用线程解析符号
+    if (d->deferredFormat || l->requiresDeferredFormat()) {
+        if (d->queue.isNull()) {
+            qApp->postEvent(this, new McRecordEvent(McLogRecord::capture(type, context, str)));
+        } else {
+            auto record = McLogRecord::capture(type, context, str);
+            record.crashSequence = McLogCrashHandler::capture(d->crashTarget, type, context, str, false);
+            enqueue(std::move(record));
+        }
+        return;
+    }
     auto message = l->format(type, context, str);
 
-    auto e = new McCustomEvent(QEvent::User, message);
-    qApp->postEvent(this, e);
+    if (d->queue.isNull()) { //!< 配置完成之前仍然逐条投递事件
+        auto e = new McCustomEvent(QEvent::User, message);
+        qApp->postEvent(this, e);
+        return;
+    }
+    McLogRecord record;
+    record.type = type; //!< 队列已满时按等级决定是否丢弃
+    if (d->timeIndexInterval > 0) {
+        record.msecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+    }
+    record.crashSequence = McLogCrashHandler::capture(d->crashTarget, type, context, message, true);
+    record.message = std::move(message);
+    record.isFormatted = true;
+    enqueue(std::move(record));
 }
 
 void McAbstractFormatAppender::doFinished() noexcept
@@ -140,9 +423,9 @@ void McAbstractFormatAppender::doThreadFinished() noexcept
     McAbstractIODeviceAppender::doThreadFinished();
 
     auto l = layout();  //!< 一定存在
-    auto pl = l.staticCast<McPatternLayout>();  //!< 一定成功
-    if(pl->thread() != thread()) {
-        pl->moveToThread(thread());
+    auto obj = dynamic_cast<QObject *>(l.data()); //!< 布局不一定是McPatternLayout
+    if (obj != nullptr && obj->thread() != thread()) {
+        obj->moveToThread(thread());
     }
 }
 
@@ -150,6 +433,9 @@ void McAbstractFormatAppender::doAllFinished() noexcept
 {
     super::doAllFinished();
 
+    if (d->multiProcess && d->useLockFile) {
+        d->useLockFile = false; //!< 多进程模式只在滚动文件时加锁
+    }
     if (!d->lockFilePath.isEmpty() && d->useLockFile) {
         auto filePath = Mc::toAbsolutePath(d->lockFilePath);
         QFileInfo fileInfo(filePath);
@@ -159,6 +445,44 @@ void McAbstractFormatAppender::doAllFinished() noexcept
         }
         d->lockFile.reset(new QLockFile(filePath));
     }
+    d->queue.reset(new McMpscRingBuffer<McLogRecord>(d->queueCapacity));
+    d->lastStatsTimer.start();
+    d->crashTarget = McLogCrashHandler::addAppender(this);
+    updateCrashFd();
+
+    auto durability = d->durability.trimmed().toLower();
+    if (durability == "fsync") {
+        d->durabilityMode = Durability::Fsync;
+    } else if (durability == "flush") {
+        d->durabilityMode = Durability::Flush;
+    } else {
+        if (!durability.isEmpty() && durability != "none") {
+            MC_PRINT_ERR("unknown durability: %s. must be one of none/flush/fsync\n",
+                         qPrintable(d->durability));
+        }
+        d->durabilityMode = Durability::None;
+    }
+    //! 多进程模式下其他进程也会追加，无法得知写出的位置；非UTF-8编码时批次内的偏移与文件不一致
+    d->timeIndexInterval = d->multiProcess || !isUtf8() ? 0 : timeIndexInterval();
+
+    auto policy = d->overflowPolicy.trimmed().toLower();
+    if (policy == "dropnewest") {
+        d->overflowMode = OverflowPolicy::DropNewest;
+    } else if (policy == "dropbelow") {
+        d->overflowMode = OverflowPolicy::DropBelow;
+    } else if (policy == "sample") {
+        d->overflowMode = OverflowPolicy::Sample;
+    } else {
+        if (!policy.isEmpty() && policy != "block") {
+            MC_PRINT_ERR("unknown overflowPolicy: %s. must be one of block/dropNewest/dropBelow/sample\n",
+                         qPrintable(d->overflowPolicy));
+        }
+        d->overflowMode = OverflowPolicy::Block;
+    }
+    //! 兼容旧配置，immediateFlush至少需要每批flush一次
+    if (d->immediateFlush && d->durabilityMode == Durability::None) {
+        d->durabilityMode = Durability::Flush;
+    }
 }
 
 void McAbstractFormatAppender::customEvent(QEvent *event) 
@@ -166,18 +490,190 @@ void McAbstractFormatAppender::customEvent(QEvent *event)
     if(event->type() == QEvent::User) {
         auto e = static_cast<McCustomEvent *>(event);
         append_helper(e->data().toString());
+    } else if (event->type() == QEvent::User + 1) {
+        drainQueue();
+    } else if (event->type() == QEvent::User + 2) {
+        auto e = static_cast<McRecordEvent *>(event);
+        auto l = layout();
+        if (!l.isNull()) {
+            append_helper(l->formatRecord(e->record));
+        }
     }
 }
 
 void McAbstractFormatAppender::append_helper(const QString &msg) noexcept
 {
-    if (d->useLockFile) {
-        if (!d->lockFile->lock()) {
-            qCritical() << "cannot use lock file for path:" << d->lockFilePath;
+    McWriteScope scope(d->writingThread);
+    if (!scope.isAcquired()) {
+        return; //!< 正在崩溃处理
+    }
+    auto data = msg.toUtf8();
+    data += lineSeparator().toUtf8();
+    writeBatch(data);
+}
+
+void McAbstractFormatAppender::enqueue(McLogRecord &&record) noexcept
+{
+    if (d->queue->tryPush(std::move(record))) {
+        d->enqueuedCount.fetch_add(1, std::memory_order_relaxed);
+        scheduleDrain();
+        return;
+    }
+    if (!shouldWaitWhenFull(record.type)) {
+        d->droppedCount.fetch_add(1, std::memory_order_relaxed);
+        scheduleDrain();
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    auto cleanup = qScopeGuard([this, &timer]() {
+        d->blockedNsecs.fetch_add(timer.nsecsElapsed(), std::memory_order_relaxed);
+        scheduleDrain();
+    });
+    auto deadline = d->blockTimeout < 0 ? QDeadlineTimer(QDeadlineTimer::Forever)
+                                        : QDeadlineTimer(d->blockTimeout);
+    while (!d->queue->tryPush(std::move(record))) {
+        //! 队列已满。本线程即为消费者时直接写出，否则挂起直到消费者取出一批
+        if (QThread::currentThread() == thread()) {
+            drainQueue();
+            continue;
+        }
+        scheduleDrain();
+        if (!d->queue->waitForSpace(deadline)) {
+            if (d->queue->tryPush(std::move(record))) {
+                break;
+            }
+            d->droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
         }
-        auto cleanup = qScopeGuard([this]() { d->lockFile->unlock(); });
     }
+    d->enqueuedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool McAbstractFormatAppender::shouldWaitWhenFull(QtMsgType type) noexcept
+{
+    if (type == QtFatalMsg) {
+        return true; //!< 进程随后就会终止，fatal消息总是等待
+    }
+    switch (d->overflowMode) {
+    case OverflowPolicy::Block:
+        return true;
+    case OverflowPolicy::DropNewest:
+        return false;
+    case OverflowPolicy::DropBelow:
+        return severityRank(type) >= d->dropThresholdRank;
+    case OverflowPolicy::Sample:
+        return d->sampleCounter.fetch_add(1, std::memory_order_relaxed) % quint64(d->sampleRate) == 0;
+    }
+    return true;
+}
+
+void McAbstractFormatAppender::appendStats(QByteArray &batch, const QByteArray &separator) noexcept
+{
+    if (d->statsInterval <= 0 || !d->lastStatsTimer.hasExpired(d->statsInterval)) {
+        return;
+    }
+    d->lastStatsTimer.start();
+    auto enqueued = enqueuedCount();
+    auto dropped = droppedCount();
+    //! 没有新消息时不输出，避免空闲时统计信息刷屏
+    if (enqueued == d->lastStatsEnqueued && dropped == d->lastStatsDropped) {
+        return;
+    }
+    d->lastStatsEnqueued = enqueued;
+    d->lastStatsDropped = dropped;
+    auto text = QStringLiteral("queue stats: enqueued=%1 dropped=%2 blockedMs=%3 capacity=%4")
+                    .arg(enqueued)
+                    .arg(dropped)
+                    .arg(blockedMsecs())
+                    .arg(d->queue->capacity());
+    QMessageLogContext context(nullptr, 0, nullptr, "McLogQt");
+    McFileUtils::appendUtf8(batch, layout()->format(QtInfoMsg, context, text));
+    batch += separator;
+}
+
+void McAbstractFormatAppender::scheduleDrain() noexcept
+{
+    //! 队列由空变为非空时才投递一次事件，之后的消息由同一次消费批量写出
+    if (d->isDrainScheduled.fetchAndStoreAcquire(true)) {
+        return;
+    }
+    qApp->postEvent(this, new QEvent(static_cast<QEvent::Type>(QEvent::User + 1)));
+}
+
+void McAbstractFormatAppender::drainQueue() noexcept
+{
+    //! 先清除标志再消费，消费期间入队的消息会重新调度，不会丢失唤醒
+    d->isDrainScheduled.storeRelease(false);
+    McWriteScope scope(d->writingThread);
+    if (!scope.isAcquired()) {
+        return; //!< 正在崩溃处理
+    }
+    //! 将队列中已有的消息直接按UTF-8拼接为一批，只加一次锁、写出一次
+    QByteArray batch;
+    auto separator = lineSeparator().toUtf8();
+    auto l = layout();
+    auto interval = d->timeIndexInterval;
+    QVector<McLogTimeIndex::Entry> indexEntries;
+    quint64 crashSequence = 0;
+    auto count = d->queue->drain(
+        [&](const McLogRecord &record) {
+            crashSequence = qMax(crashSequence, record.crashSequence);
+            if (interval > 0) {
+                //! 只在时间桶变化时记录位置，同一时间桶的后续记录不会再计入索引
+                auto bucket = record.msecsSinceEpoch - record.msecsSinceEpoch % interval;
+                if (indexEntries.isEmpty() || indexEntries.last().msecsSinceEpoch != bucket) {
+                    indexEntries.append({bucket, batch.size()});
+                }
+            }
+            if (record.isFormatted) {
+                McFileUtils::appendUtf8(batch, record.message);
+            } else {
+                l->formatRecordUtf8(record, batch);
+            }
+            batch += separator;
+        },
+        d->queue->capacity());
+    if (count > 0) {
+        appendStats(batch, separator);
+        writeBatch(batch);
+        McLogCrashHandler::markWritten(d->crashTarget, crashSequence);
+        if (!indexEntries.isEmpty()) {
+            for (auto &entry : indexEntries) {
+                entry.offset += d->batchOffset;
+            }
+            writeTimeIndex(indexEntries);
+        }
+    }
+    //! 单次最多写出一个队列容量的消息，避免长时间占用事件循环
+    if (!d->queue->isEmpty()) {
+        scheduleDrain();
+    }
+}
+
+void McAbstractFormatAppender::writeBatch(const QByteArray &batch) noexcept
+{
+    if (d->multiProcess) {
+        writeBefore();
+        auto data = isUtf8() ? batch : encodeUtf8(batch);
+        writeAtomic(data);
+        d->bytesWritten += data.size();
+        if (d->durabilityMode == Durability::Fsync) {
+            syncDevice();
+        }
+        writeAfter();
+        return;
+    }
+    if (d->useLockFile && !d->lockFile->lock()) {
+        qCritical() << "cannot use lock file for path:" << d->lockFilePath;
+    }
+    auto cleanup = qScopeGuard([this]() {
+        if (d->useLockFile) {
+            d->lockFile->unlock();
+        }
+    });
     writeBefore();
+    d->batchOffset = d->bytesWritten; //!< writeBefore中可能已切换文件
     auto out = device();
     if(out.isNull() || !out->isOpen()) {
         return;
@@ -185,23 +681,139 @@ void McAbstractFormatAppender::append_helper(const QString &msg) noexcept
     if (d->useLockFile && !out->isSequential()) {
         out->seek(out->size());
     }
-    textStream() << msg;
-    if (d->immediateFlush || d->useLockFile) {
-#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-        textStream() << endl;
-#else
-        textStream() << Qt::endl;
-#endif
-    } else {
-#ifdef Q_OS_WIN
-        if (out->openMode().testFlag(QIODevice::Text)) {
-            textStream() << "\r\n";
-        } else {
-            textStream() << "\n";
-        }
-#else
-        textStream() << "\n";
-#endif
+    d->bytesWritten += writeUtf8(batch);
+    //! 使用文件锁时必须在解锁前写出，否则其他进程可能覆盖。
+    //! 安装了崩溃处理时也立即写出，信号处理函数无法安全地刷新QFile的缓冲区
+    if (d->durabilityMode != Durability::None || d->immediateFlush || d->useLockFile
+        || McLogCrashHandler::isInstalled()) {
+        flushDevice();
+    }
+    if (d->durabilityMode == Durability::Fsync) {
+        syncDevice();
     }
     writeAfter();
 }
+
+void McAbstractFormatAppender::writeAtomic(const QByteArray &data) noexcept
+{
+    auto out = device();
+    if (out.isNull() || !out->isOpen()) {
+        return;
+    }
+    //! 设备以O_APPEND无缓冲打开，每次write都会原子地追加到文件末尾。
+    //! 超过atomicWriteSize时在行尾切分，单条消息不会被拆开
+    qsizetype pos = 0;
+    while (pos < data.size()) {
+        auto len = qMin<qsizetype>(qMax(1, d->atomicWriteSize), data.size() - pos);
+        if (pos + len < data.size()) {
+            auto lineEnd = data.lastIndexOf('\n', pos + len - 1);
+            if (lineEnd >= pos) {
+                len = lineEnd - pos + 1;
+            } else {
+                lineEnd = data.indexOf('\n', pos + len);
+                len = (lineEnd == -1 ? data.size() : lineEnd + 1) - pos;
+            }
+        }
+        if (out->write(data.constData() + pos, len) != len) {
+            MC_PRINT_ERR("failed to write log: %s\n", qPrintable(out->errorString()));
+            return;
+        }
+        pos += len;
+    }
+}
+
+void McAbstractFormatAppender::emergencyFlush() noexcept
+{
+    //! 崩溃发生在写设备的过程中时设备和队列的状态都不可信，直接跳过
+    Qt::HANDLE expected = nullptr;
+    if (!d->writingThread.compare_exchange_strong(expected,
+                                                  QThread::currentThreadId(),
+                                                  std::memory_order_acquire)) {
+        return;
+    }
+    auto file = qobject_cast<QFileDevice *>(device().data());
+    if (file == nullptr || !file->isOpen() || file->handle() == -1) {
+        return;
+    }
+    //! 先写出QFile中已格式化但还在缓冲区的内容
+    file->flush();
+    if (d->queue.isNull()) {
+        return;
+    }
+    auto fd = file->handle();
+    auto separator = lineSeparator().toUtf8();
+    auto l = layout();
+    quint64 crashSequence = 0;
+    d->queue->drain(
+        [fd, &separator, &l, &crashSequence](const McLogRecord &record) {
+            crashSequence = qMax(crashSequence, record.crashSequence);
+            QByteArray data;
+            if (record.isFormatted) {
+                McFileUtils::appendUtf8(data, record.message);
+            } else {
+                l->formatRecordUtf8(record, data);
+            }
+            data += separator;
+            McLogCrashHandler::writeAll(fd, data.constData(), data.size());
+        },
+        d->queue->capacity());
+    //! 随后的abort会进入信号处理函数，已写出的记录不要再写一次
+    McLogCrashHandler::markWritten(d->crashTarget, crashSequence);
+}
+
+void McAbstractFormatAppender::updateCrashFd() noexcept
+{
+    if (d->crashTarget == -1) {
+        return;
+    }
+    auto file = qobject_cast<QFileDevice *>(device().data());
+    auto fd = file != nullptr && file->isOpen() ? file->handle() : -1;
+    McLogCrashHandler::setAppenderFd(d->crashTarget, fd, lineSeparator() == QLatin1String("\r\n"));
+}
+
+qint64 McAbstractFormatAppender::bytesWritten() const noexcept
+{
+    return d->bytesWritten;
+}
+
+void McAbstractFormatAppender::setBytesWritten(qint64 val) noexcept
+{
+    d->bytesWritten = val;
+}
+
+void McAbstractFormatAppender::syncDevice() noexcept
+{
+    if (d->lastSyncTimer.isValid() && !d->lastSyncTimer.hasExpired(d->fsyncInterval)) {
+        //! 间隔未到，推迟到间隔结束时再同步，保证最后一批消息最终也会落盘
+        if (!d->isSyncScheduled) {
+            d->isSyncScheduled = true;
+            auto remaining = qMax<qint64>(0, d->fsyncInterval - d->lastSyncTimer.elapsed());
+            QTimer::singleShot(remaining, this, [this]() {
+                d->isSyncScheduled = false;
+                syncDevice();
+            });
+        }
+        return;
+    }
+    auto file = qobject_cast<QFileDevice *>(device().data());
+    if (file == nullptr) {
+        return;
+    }
+    flushDevice();
+    if (!McFileUtils::syncFile(file)) {
+        MC_PRINT_ERR("failed to sync file: %s\n", qPrintable(file->fileName()));
+    }
+    d->lastSyncTimer.start();
+}
+
+QString McAbstractFormatAppender::lineSeparator() const noexcept
+{
+#ifdef Q_OS_WIN
+    //! Text模式的设备会把\n转换为\r\n，此时再写出\r\n会得到\r\r\n，且写出的字节数与文件不一致
+    auto out = device();
+    if (out.isNull() || !out->openMode().testFlag(QIODevice::Text)) {
+        return QStringLiteral("\r\n");
+    }
+#endif
+    return QStringLiteral("\n");
+}
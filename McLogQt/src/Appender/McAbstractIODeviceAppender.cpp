@@ -23,18 +23,18 @@
  */
 #include "McLog/Appender/impl/McAbstractIODeviceAppender.h"
 
+#include <QFileDevice>
 #include <QIODevice>
 #include <QTextCodec>
-#include <QTextStream>
 
 MC_INIT(McAbstractIODeviceAppender)
 MC_INIT_END
 
 MC_DECL_PRIVATE_DATA(McAbstractIODeviceAppender)
 QIODevicePtr device;
-QTextStream textStream;
 QByteArray codecName{"UTF-8"};
 QTextCodec *codec{nullptr};
+bool isUtf8{true}; //!< 编码为UTF-8时直接写出格式化好的字节，否则先经过codec转换
 MC_DECL_PRIVATE_DATA_END
 
 McAbstractIODeviceAppender::McAbstractIODeviceAppender()
@@ -82,14 +82,43 @@ void McAbstractIODeviceAppender::doAllFinished() noexcept
 {
     McAbstractAppender::doAllFinished();
 
-    d->textStream.setDevice(d->device.data());
     if (d->codec == nullptr) {
         d->codec = QTextCodec::codecForName(d->codecName);
     }
-    //    d->textStream.setCodec(d->codec);
+    //! UTF-8的MIB为106
+    d->isUtf8 = d->codec == nullptr || d->codec->mibEnum() == 106;
 }
 
-QTextStream &McAbstractIODeviceAppender::textStream() noexcept
+bool McAbstractIODeviceAppender::isUtf8() const noexcept
 {
-    return d->textStream;
+    return d->isUtf8;
+}
+
+QByteArray McAbstractIODeviceAppender::encodeUtf8(const QByteArray &data) const noexcept
+{
+    //! 非UTF-8编码的慢速路径，需要先解码再按codec重新编码
+    return d->codec->fromUnicode(QString::fromUtf8(data));
+}
+
+qint64 McAbstractIODeviceAppender::writeUtf8(const QByteArray &data) noexcept
+{
+    auto out = d->device;
+    if (out.isNull() || !out->isOpen() || data.isEmpty()) {
+        return 0;
+    }
+    auto encoded = d->isUtf8 ? data : encodeUtf8(data);
+    auto size = out->write(encoded);
+    if (size != encoded.size()) {
+        MC_PRINT_ERR("failed to write log: %s\n", qPrintable(out->errorString()));
+    }
+    return qMax<qint64>(size, 0);
+}
+
+void McAbstractIODeviceAppender::flushDevice() noexcept
+{
+    //! 只有QFileDevice自带写缓冲区，其他设备写入即生效
+    auto file = qobject_cast<QFileDevice *>(d->device.data());
+    if (file != nullptr && file->isOpen()) {
+        file->flush();
+    }
 }
@@ -0,0 +1,270 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Appender/impl/McBinaryFileAppender.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QRegularExpression>
+#include <QThread>
+
+#include "McLog/Utils/McBinaryLog.h"
+#include "McLog/Utils/McFileUtils.h"
+#include "McLog/Utils/McRingBuffer.h"
+
+MC_DECL_PRIVATE_DATA(McBinaryFileAppender)
+QString dirPath;
+QString fileNamePattern{"log_%{time yyyy-MM-dd_hh-mm-ss}.mclog"};
+QString maxFileSize;
+qint64 maxFileSizeBytes{-1}; //!< 单位: byte，默认-1表示不创建新文件
+int queueCapacity{8192};
+QScopedPointer<McMpscRingBuffer<McLogRecord>> queue;
+QAtomicInteger<bool> isDrainScheduled{false};
+QScopedPointer<QFile> file;
+QHash<QByteArray, quint64> stringIds; //!< 当前文件中已写出的字符串，按内容查找
+quint64 nextStringId{1};
+qint64 lastMsecs{0};
+qint64 lastMonotonicMsecs{0};
+MC_DECL_PRIVATE_DATA_END
+
+MC_INIT(McBinaryFileAppender)
+MC_REGISTER_BEAN_FACTORY(McBinaryFileAppender)
+MC_INIT_END
+
+McBinaryFileAppender::McBinaryFileAppender()
+{
+    MC_NEW_PRIVATE_DATA(McBinaryFileAppender);
+}
+
+McBinaryFileAppender::~McBinaryFileAppender()
+{
+    //! 此时已不会再有生产者，写出剩余的记录
+    if (!d->queue.isNull()) {
+        while (writeQueued(d->queue->capacity()) > 0) {
+        }
+    }
+}
+
+QString McBinaryFileAppender::dirPath() const noexcept
+{
+    return d->dirPath;
+}
+
+void McBinaryFileAppender::setDirPath(const QString &val) noexcept
+{
+    d->dirPath = Mc::toAbsolutePath(val);
+}
+
+QString McBinaryFileAppender::fileNamePattern() const noexcept
+{
+    return d->fileNamePattern;
+}
+
+void McBinaryFileAppender::setFileNamePattern(const QString &val) noexcept
+{
+    d->fileNamePattern = val;
+}
+
+QString McBinaryFileAppender::maxFileSize() const noexcept
+{
+    return d->maxFileSize;
+}
+
+void McBinaryFileAppender::setMaxFileSize(const QString &val) noexcept
+{
+    d->maxFileSize = val.toUpper();
+    d->maxFileSizeBytes = McFileUtils::sizeFromString(d->maxFileSize);
+}
+
+int McBinaryFileAppender::queueCapacity() const noexcept
+{
+    return d->queueCapacity;
+}
+
+void McBinaryFileAppender::setQueueCapacity(int val) noexcept
+{
+    d->queueCapacity = val;
+}
+
+void McBinaryFileAppender::append(QtMsgType type,
+                                  const QMessageLogContext &context,
+                                  const QString &str) noexcept
+{
+    if (!types().contains(type) || d->queue.isNull()) {
+        return;
+    }
+    auto record = McLogRecord::capture(type, context, str);
+    while (!d->queue->tryPush(std::move(record))) {
+        //! 队列已满。本线程即为消费者时直接写出，否则挂起直到消费者取出一批
+        if (QThread::currentThread() == thread()) {
+            writeQueued(d->queue->capacity());
+            continue;
+        }
+        scheduleDrain();
+        d->queue->waitForSpace(QDeadlineTimer(QDeadlineTimer::Forever));
+    }
+    scheduleDrain();
+}
+
+void McBinaryFileAppender::doFinished() noexcept
+{
+    super::doFinished();
+
+    d->queue.reset(new McMpscRingBuffer<McLogRecord>(d->queueCapacity));
+}
+
+void McBinaryFileAppender::customEvent(QEvent *event)
+{
+    if (event->type() == QEvent::User + 1) {
+        drainQueue();
+    }
+}
+
+void McBinaryFileAppender::scheduleDrain() noexcept
+{
+    if (d->isDrainScheduled.fetchAndStoreAcquire(true)) {
+        return;
+    }
+    qApp->postEvent(this, new QEvent(static_cast<QEvent::Type>(QEvent::User + 1)));
+}
+
+void McBinaryFileAppender::drainQueue() noexcept
+{
+    d->isDrainScheduled.storeRelease(false);
+    writeQueued(d->queue->capacity());
+    if (!d->queue->isEmpty()) {
+        scheduleDrain();
+    }
+}
+
+int McBinaryFileAppender::writeQueued(int maxCount) noexcept
+{
+    if (d->queue->isEmpty()) {
+        return 0;
+    }
+    if (d->file.isNull() || !d->file->isOpen()
+        || (d->maxFileSizeBytes > 0 && d->file->size() >= d->maxFileSizeBytes)) {
+        if (!openNewFile()) {
+            //! 无法写出时丢弃，避免队列一直处于满的状态阻塞生产者
+            return d->queue->drain([](const McLogRecord &) {}, maxCount);
+        }
+    }
+    QByteArray batch;
+    QByteArray payload;
+    auto count = d->queue->drain(
+        [this, &batch, &payload](const McLogRecord &record) {
+            //! 字符串定义需要先于引用它的日志记录写出
+            auto categoryId = internString(batch, record.category);
+            auto fileId = internString(batch, record.file);
+            auto functionId = internString(batch, record.function);
+
+            payload.clear();
+            payload.append(static_cast<char>(McBinaryLog::Log));
+            payload.append(static_cast<char>(record.type));
+            McBinaryLog::putVarint(payload, categoryId);
+            McBinaryLog::putVarint(payload, fileId);
+            McBinaryLog::putVarint(payload, functionId);
+            McBinaryLog::putVarint(payload, McBinaryLog::zigzag(record.line));
+            McBinaryLog::putVarint(payload, McBinaryLog::zigzag(record.msecsSinceEpoch - d->lastMsecs));
+            McBinaryLog::putVarint(payload,
+                                   McBinaryLog::zigzag(record.monotonicMsecs - d->lastMonotonicMsecs));
+            McBinaryLog::putVarint(payload, McBinaryLog::zigzag(record.threadId));
+            McBinaryLog::putVarint(payload, record.qthreadPtr);
+            payload.append(record.message.toUtf8());
+            d->lastMsecs = record.msecsSinceEpoch;
+            d->lastMonotonicMsecs = record.monotonicMsecs;
+
+            McBinaryLog::putVarint(batch, static_cast<quint64>(payload.size()));
+            batch.append(payload);
+        },
+        maxCount);
+    if (d->file->write(batch) != batch.size() || !d->file->flush()) {
+        MC_PRINT_ERR("failed to write binary log file: %s\n", qPrintable(d->file->fileName()));
+    }
+    return count;
+}
+
+bool McBinaryFileAppender::openNewFile() noexcept
+{
+    QDir dir(d->dirPath);
+    if (!dir.exists() && !dir.mkpath(d->dirPath)) {
+        MC_PRINT_ERR("the dir path: %s is not exists. but cannot create!\n", qPrintable(d->dirPath));
+        return false;
+    }
+    QString fileName = d->fileNamePattern;
+    QRegularExpression re(R"((.*)%\{time (.*?)\}(.*))");
+    auto match = re.match(d->fileNamePattern);
+    if (match.hasMatch()) {
+        auto list = match.capturedTexts();
+        fileName = list.at(1) + QDateTime::currentDateTime().toString(list.at(2)) + list.at(3);
+    }
+    auto filePath = dir.absoluteFilePath(fileName);
+    //! 编号和时间差只在同一个文件内有效，不能追加到已存在的文件
+    for (int i = 1; QFile::exists(filePath); ++i) {
+        filePath = dir.absoluteFilePath(QStringLiteral("%1.%2").arg(fileName).arg(i));
+    }
+
+    if (!d->file.isNull()) {
+        d->file->close();
+    }
+    d->file.reset(new QFile(filePath));
+    if (!d->file->open(QIODevice::WriteOnly)) {
+        MC_PRINT_ERR("error open file '%s' for write!!!\n", qPrintable(filePath));
+        return false;
+    }
+    d->stringIds.clear();
+    d->nextStringId = 1;
+    d->lastMsecs = 0;
+    d->lastMonotonicMsecs = 0;
+
+    QByteArray header(McBinaryLog::Magic, McBinaryLog::MagicSize);
+    header.append(static_cast<char>(McBinaryLog::Version));
+    d->file->write(header);
+    return true;
+}
+
+quint64 McBinaryFileAppender::internString(QByteArray &out, const char *str) noexcept
+{
+    if (str == nullptr) {
+        return 0;
+    }
+    //! 记录中的字符串是capture时的拷贝，每条记录的指针都不同，只能按内容查找
+    auto key = QByteArray::fromRawData(str, static_cast<int>(qstrlen(str)));
+    auto itr = d->stringIds.constFind(key);
+    if (itr != d->stringIds.constEnd()) {
+        return itr.value();
+    }
+    auto id = d->nextStringId++;
+    d->stringIds.insert(QByteArray(key.constData(), key.size()), id);
+
+    QByteArray payload;
+    payload.append(static_cast<char>(McBinaryLog::String));
+    McBinaryLog::putVarint(payload, id);
+    payload.append(key);
+    McBinaryLog::putVarint(out, static_cast<quint64>(payload.size()));
+    out.append(payload);
+    return id;
+}
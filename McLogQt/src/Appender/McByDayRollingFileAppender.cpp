@@ -23,6 +23,7 @@
  */
 #include "McLog/Appender/impl/McByDayRollingFileAppender.h"
 
+#include <QDateTime>
 #include <QFile>
 
 #include "McLog/Utils/McFileUtils.h"
@@ -33,6 +34,8 @@ MC_INIT_END
 
 MC_DECL_PRIVATE_DATA(McByDayRollingFileAppender)
 int day{1};
+QDateTime fileBirthTime;
+qint64 deadline{-1}; //!< 需要切换文件的时刻，-1表示需要重新计算
 MC_DECL_PRIVATE_DATA_END
 
 McByDayRollingFileAppender::McByDayRollingFileAppender()
@@ -50,6 +53,7 @@ int McByDayRollingFileAppender::day() const noexcept
 void McByDayRollingFileAppender::setDay(int val) noexcept
 {
     d->day = val;
+    d->deadline = -1;
 }
 
 bool McByDayRollingFileAppender::isNewNextFile() noexcept
@@ -61,6 +65,17 @@ bool McByDayRollingFileAppender::isNewNextFile() noexcept
     if (!file->isOpen()) {
         return false;
     }
-    auto filePath = file->fileName();
-    return McFileUtils::judgeDate(filePath, d->day);
+    //! 文件创建时间在打开时获取一次，之后只需比较当前时间
+    if (d->deadline == -1) {
+        d->deadline = McFileUtils::dateDeadline(d->fileBirthTime, d->day);
+    }
+    return QDateTime::currentMSecsSinceEpoch() >= d->deadline;
+}
+
+void McByDayRollingFileAppender::fileOpened(const QString &filePath) noexcept
+{
+    McRollingFileAppender::fileOpened(filePath);
+
+    d->fileBirthTime = McFileUtils::birthTime(filePath);
+    d->deadline = -1;
 }
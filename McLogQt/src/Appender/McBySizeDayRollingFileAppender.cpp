@@ -23,6 +23,7 @@
  */
 #include "McLog/Appender/impl/McBySizeDayRollingFileAppender.h"
 
+#include <QDateTime>
 #include <QFile>
 
 #include "McLog/Utils/McFileUtils.h"
@@ -33,6 +34,8 @@ MC_INIT_END
 
 MC_DECL_PRIVATE_DATA(McBySizeDayRollingFileAppender)
 int day{1};
+QDateTime fileBirthTime;
+qint64 deadline{-1}; //!< 需要切换文件的时刻，-1表示需要重新计算
 MC_DECL_PRIVATE_DATA_END
 
 McBySizeDayRollingFileAppender::McBySizeDayRollingFileAppender()
@@ -50,6 +53,7 @@ int McBySizeDayRollingFileAppender::day() const noexcept
 void McBySizeDayRollingFileAppender::setDay(int val) noexcept
 {
     d->day = val;
+    d->deadline = -1;
 }
 
 bool McBySizeDayRollingFileAppender::isNewNextFile() noexcept
@@ -64,6 +68,17 @@ bool McBySizeDayRollingFileAppender::isNewNextFile() noexcept
     if (!file->isOpen()) {
         return false;
     }
-    auto filePath = file->fileName();
-    return McFileUtils::judgeDate(filePath, d->day);
+    //! 文件创建时间在打开时获取一次，之后只需比较当前时间
+    if (d->deadline == -1) {
+        d->deadline = McFileUtils::dateDeadline(d->fileBirthTime, d->day);
+    }
+    return QDateTime::currentMSecsSinceEpoch() >= d->deadline;
+}
+
+void McBySizeDayRollingFileAppender::fileOpened(const QString &filePath) noexcept
+{
+    McSizeRollingFileAppender::fileOpened(filePath);
+
+    d->fileBirthTime = McFileUtils::birthTime(filePath);
+    d->deadline = -1;
 }
@@ -27,15 +27,22 @@
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
-#include <QRegularExpression>
-#include <QRegularExpressionMatch>
 #include <QDateTime>
 
+#include "McLog/Utils/McFileUtils.h"
+
 MC_DECL_PRIVATE_DATA(McFileAppender)
 QString dirPath;
 QString fileNamePattern;
+QString filePrefix;     //!< 以下为fileNamePattern预先拆分的结果
+QString fileTimeFormat;
+QString fileSuffix;
+bool hasFileTime{false};
 bool isAppend{true};
-MC_PADDING_CLANG(7)
+MC_PADDING_CLANG(2)
+int indexInterval{0};
+QScopedPointer<QFile> indexFile;
+qint64 lastIndexedBucket{-1}; //!< 索引文件中最后一个时间桶，避免跨批次重复记录
 MC_DECL_PRIVATE_DATA_END
 
 MC_INIT(McFileAppender)
@@ -69,6 +76,7 @@ QString McFileAppender::fileNamePattern() const noexcept
 void McFileAppender::setFileNamePattern(const QString &val) noexcept 
 {
     d->fileNamePattern = val;
+    d->hasFileTime = McFileUtils::parseTimePattern(val, d->filePrefix, d->fileTimeFormat, d->fileSuffix);
 }
 
 bool McFileAppender::isAppend() const noexcept 
@@ -81,6 +89,16 @@ void McFileAppender::setAppend(bool val) noexcept
     d->isAppend = val;
 }
 
+int McFileAppender::indexInterval() const noexcept
+{
+    return d->indexInterval;
+}
+
+void McFileAppender::setIndexInterval(int val) noexcept
+{
+    d->indexInterval = qMax(0, val);
+}
+
 void McFileAppender::doFinished() noexcept
 {
     super::doFinished();
@@ -91,34 +109,23 @@ void McFileAppender::doFinished() noexcept
 
 QString McFileAppender::newFilePath() const noexcept 
 {
-    QRegularExpression re(R"((.*)%\{time (.*?)\}(.*))");
-    auto match = re.match(d->fileNamePattern);
-    
     QDir dir(d->dirPath);
-    if(!match.hasMatch()) {
+    if (!d->hasFileTime) {
         return dir.absoluteFilePath(d->fileNamePattern);
     }
-    
-    auto list = match.capturedTexts();
-    return dir.absoluteFilePath(list.at(1) 
-                                + QDateTime::currentDateTime().toString(list.at(2)) 
-                                + list.at(3));
+    return dir.absoluteFilePath(d->filePrefix
+                                + QDateTime::currentDateTime().toString(d->fileTimeFormat)
+                                + d->fileSuffix);
 }
 
 bool McFileAppender::checkExistsFile() noexcept
 {
     QString oldFilePath;
     auto file = device().staticCast<QFile>();
-    if (file.isNull()) {
-        file = QSharedPointer<QFile>::create();
-        setDevice(file);
-    } else {
+    if (!file.isNull()) {
         oldFilePath = file->fileName();
     }
 
-    QRegularExpression re(R"((.*)%\{time (.*?)\}(.*))");
-    auto match = re.match(d->fileNamePattern);
-
     QDir dir(d->dirPath);
     if (!dir.exists() && !dir.mkpath(d->dirPath)) {
         MC_PRINT_ERR("the dir path: %s is not exists. but cannot create!\n", qPrintable(d->dirPath));
@@ -128,14 +135,13 @@ bool McFileAppender::checkExistsFile() noexcept
     QString localFilePath;
     for (auto &fileInfo : qAsConst(fileInfos)) {
         auto fileName = fileInfo.fileName();
-        if (match.hasMatch()) { //!< 如果匹配成功，则list的长度一定为4
-            auto list = match.capturedTexts();
-            if (!fileName.startsWith(list.at(1)) || !fileName.endsWith(list.at(3))) {
+        if (d->hasFileTime) {
+            if (!fileName.startsWith(d->filePrefix) || !fileName.endsWith(d->fileSuffix)) {
                 continue;
             }
-            fileName.remove(fileName.size() - list.at(3).size(), list.at(3).size()); //!< 移除末尾
-            fileName.remove(0, list.at(1).size()); //!< 移除开头
-            QDateTime dateTime = QDateTime::fromString(fileName, list.at(2));
+            fileName.remove(fileName.size() - d->fileSuffix.size(), d->fileSuffix.size()); //!< 移除末尾
+            fileName.remove(0, d->filePrefix.size()); //!< 移除开头
+            QDateTime dateTime = QDateTime::fromString(fileName, d->fileTimeFormat);
             if (!dateTime.isValid()) {
                 continue;
             }
@@ -154,14 +160,96 @@ bool McFileAppender::checkExistsFile() noexcept
         localFilePath = newFilePath();
     }
 
-    file->setFileName(localFilePath);
-    QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Text;
+    return openFile(localFilePath);
+}
+
+bool McFileAppender::openFile(const QString &filePath) noexcept
+{
+    auto file = device().staticCast<QFile>();
+    if (file.isNull()) {
+        file = QSharedPointer<QFile>::create();
+        setDevice(file);
+    }
+    if (file->isOpen()) {
+        file->close();
+        updateCrashFd();
+    }
+    QDir dir(d->dirPath);
+    if (!dir.exists() && !dir.mkpath(d->dirPath)) {
+        MC_PRINT_ERR("the dir path: %s is not exists. but cannot create!\n", qPrintable(d->dirPath));
+        return false;
+    }
+
+    file->setFileName(filePath);
+    //! 不使用Text模式，换行符由lineSeparator写出，保证bytesWritten和时间索引的偏移与文件一致
+    QIODevice::OpenMode mode = QIODevice::WriteOnly;
     if (d->isAppend)
         mode |= QIODevice::Append;
+    if (multiProcess()) {
+        //! O_APPEND保证每次write原子地追加到末尾；无缓冲，保证一批消息只调用一次write
+        mode = QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered;
+    }
     if (!file->open(mode)) {
-        MC_PRINT_ERR("error open file '%s' for write!!!\n", qPrintable(localFilePath));
+        MC_PRINT_ERR("error open file '%s' for write!!!\n", qPrintable(filePath));
         return false;
     }
+    setBytesWritten(file->size());
+    updateCrashFd();
+    if (d->indexInterval > 0 && !multiProcess()) {
+        openTimeIndex(filePath, file->size() == 0);
+    }
+    fileOpened(filePath);
 
     return true;
 }
+
+void McFileAppender::fileOpened(const QString &filePath) noexcept
+{
+    Q_UNUSED(filePath)
+}
+
+qint64 McFileAppender::timeIndexInterval() const noexcept
+{
+    return d->indexInterval;
+}
+
+void McFileAppender::writeTimeIndex(const QVector<McLogTimeIndex::Entry> &entries) noexcept
+{
+    if (d->indexFile.isNull() || !d->indexFile->isOpen()) {
+        return;
+    }
+    QByteArray data;
+    for (auto &entry : entries) {
+        if (entry.msecsSinceEpoch == d->lastIndexedBucket) {
+            continue;
+        }
+        d->lastIndexedBucket = entry.msecsSinceEpoch;
+        McLogTimeIndex::appendEntry(data, entry);
+    }
+    //! 索引很小，每次都写出。日志仍在缓冲区时索引可能指向文件末尾之后，读取时以实际长度为准
+    if (!data.isEmpty() && (d->indexFile->write(data) != data.size() || !d->indexFile->flush())) {
+        MC_PRINT_ERR("failed to write time index: %s\n", qPrintable(d->indexFile->fileName()));
+    }
+}
+
+void McFileAppender::closeTimeIndex() noexcept
+{
+    if (!d->indexFile.isNull()) {
+        d->indexFile->close();
+    }
+    d->lastIndexedBucket = -1;
+}
+
+void McFileAppender::openTimeIndex(const QString &filePath, bool isNewFile) noexcept
+{
+    closeTimeIndex();
+    d->indexFile.reset(new QFile(McLogTimeIndex::indexPath(filePath)));
+    auto mode = QIODevice::WriteOnly | (isNewFile ? QIODevice::Truncate : QIODevice::Append);
+    if (!d->indexFile->open(mode)) {
+        MC_PRINT_ERR("error open time index '%s' for write!!!\n", qPrintable(d->indexFile->fileName()));
+        return;
+    }
+    if (d->indexFile->size() == 0) {
+        d->indexFile->write(McLogTimeIndex::header(d->indexInterval));
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Appender/impl/McMmapFileAppender.h"
+
+#include "McLog/Device/McMmapFileDevice.h"
+#include "McLog/Utils/McFileUtils.h"
+
+MC_INIT(McMmapFileAppender)
+MC_REGISTER_BEAN_FACTORY(McMmapFileAppender)
+MC_INIT_END
+
+MC_DECL_PRIVATE_DATA(McMmapFileAppender)
+QString dirPath;
+QString fileNamePattern{"log_%{time yyyy-MM-dd_hh-mm-ss}.log"};
+QString segmentSize{"64MB"};
+MC_DECL_PRIVATE_DATA_END
+
+McMmapFileAppender::McMmapFileAppender() noexcept
+{
+    MC_NEW_PRIVATE_DATA(McMmapFileAppender);
+}
+
+McMmapFileAppender::~McMmapFileAppender()
+{
+}
+
+QString McMmapFileAppender::dirPath() const noexcept
+{
+    return d->dirPath;
+}
+
+void McMmapFileAppender::setDirPath(const QString &val) noexcept
+{
+    d->dirPath = Mc::toAbsolutePath(val);
+}
+
+QString McMmapFileAppender::fileNamePattern() const noexcept
+{
+    return d->fileNamePattern;
+}
+
+void McMmapFileAppender::setFileNamePattern(const QString &val) noexcept
+{
+    d->fileNamePattern = val;
+}
+
+QString McMmapFileAppender::segmentSize() const noexcept
+{
+    return d->segmentSize;
+}
+
+void McMmapFileAppender::setSegmentSize(const QString &val) noexcept
+{
+    d->segmentSize = val.toUpper();
+}
+
+void McMmapFileAppender::doFinished() noexcept
+{
+    super::doFinished();
+
+    if (useLockFile()) {
+        MC_PRINT_ERR("McMmapFileAppender not support lock file\n");
+        setUseLockFile(false);
+    }
+    if (multiProcess()) {
+        MC_PRINT_ERR("McMmapFileAppender not support multi process\n");
+        setMultiProcess(false);
+    }
+    auto size = McFileUtils::sizeFromString(d->segmentSize);
+    if (size <= 0) {
+        MC_PRINT_ERR("invalid segment size: %s\n", qPrintable(d->segmentSize));
+        return;
+    }
+    auto dev = McMmapFileDevicePtr::create();
+    dev->setDirPath(d->dirPath);
+    dev->setFileNamePattern(d->fileNamePattern);
+    dev->setSegmentSize(size);
+    if (!dev->open(QIODevice::WriteOnly)) {
+        MC_PRINT_ERR("error open mmap file in '%s': %s\n",
+                     qPrintable(d->dirPath),
+                     qPrintable(dev->errorString()));
+        return;
+    }
+
+    setDevice(dev);
+}
+
+void McMmapFileAppender::writeBefore() noexcept
+{
+}
+
+void McMmapFileAppender::writeAfter() noexcept
+{
+}
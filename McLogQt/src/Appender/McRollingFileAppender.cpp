@@ -27,12 +27,123 @@
 #include <QDateTime>
 #include <QDir>
 #include <QRegularExpression>
-#include <QRegularExpressionMatch>
+#include <QScopeGuard>
 #include <QThread>
 
+#include "McLog/Utils/McFileUtils.h"
+#include "McLog/Utils/McLogFileIndex.h"
+#include "McLog/Utils/McLogMaintainer.h"
+#include "McLog/Utils/McLogTimeIndex.h"
+
+#ifndef MC_DISABLE_QUAZIP
+#include <McIoc/Utils/Zip/McCompressor.h>
+#endif
+
+namespace {
+
+//! 预先拆分的备份目录模式，会被复制到后台任务中使用
+struct McBackupPattern
+{
+    QString dirPath;
+    QString pattern;
+    QString prefix;
+    QString timeFormat;
+    QString suffix;
+    bool hasTime{false};
+    bool compress{false};
+    qint64 compressBytesPerSecond{0};
+};
+
+QString newBackupPath(const McBackupPattern &backup, const QString &oldFilePath) noexcept
+{
+    QDir dir(backup.dirPath);
+    if (!backup.hasTime) {
+        return dir.absoluteFilePath(backup.pattern);
+    }
+    auto dateTime = McFileUtils::birthTime(oldFilePath);
+    if (!dateTime.isValid()) {
+        qCritical("failed get birth time of the file: %s\n", qPrintable(oldFilePath));
+    }
+    return dir.absoluteFilePath(backup.prefix + dateTime.toString(backup.timeFormat) + backup.suffix);
+}
+
+QString moveToBackup(const McBackupPattern &backup, const QString &rollingPath, const QString &fileName) noexcept
+{
+    auto backupPath = newBackupPath(backup, rollingPath);
+    QDir dir(backupPath);
+    if (!dir.exists() && !dir.mkpath(backupPath)) {
+        MC_PRINT_ERR("mk the backup path: %s failure.\n", qPrintable(backupPath));
+        return QString();
+    }
+    //! 备份目录中已有同名文件(如同一秒内滚动多次或重启后文件名重复)时追加序号，压缩时还要避开.gz文件
+    auto filePath = dir.absoluteFilePath(fileName);
+    for (int i = 1; QFile::exists(filePath) || (backup.compress && QFile::exists(filePath + QStringLiteral(".gz")));
+         ++i) {
+        filePath = dir.absoluteFilePath(QStringLiteral("%1.%2").arg(fileName).arg(i));
+    }
+    if (!QFile::rename(rollingPath, filePath)) {
+        MC_PRINT_ERR("move the file: %s to backup path: %s failure.\n",
+                     qPrintable(rollingPath),
+                     qPrintable(backupPath));
+        //! 移动失败的文件留在原处，交给文件索引，使McLogDeleter等任务仍能按时清理
+        McLogFileIndex::fileAdded(rollingPath);
+        return QString();
+    }
+    //! 时间索引跟随日志文件，压缩后仍然使用同一个索引
+    auto indexPath = McLogTimeIndex::indexPath(rollingPath);
+    if (QFile::exists(indexPath)) {
+        QFile::rename(indexPath, McLogTimeIndex::indexPath(filePath));
+    }
+    return filePath;
+}
+
+void compressBackup(const McBackupPattern &backup, const QString &filePath) noexcept
+{
+#ifndef MC_DISABLE_QUAZIP
+    //! 进程退出时不再压缩，文件以未压缩的形式留在备份目录中
+    if (McLogMaintainer::isShuttingDown()) {
+        return;
+    }
+    auto gzPath = filePath + QStringLiteral(".gz");
+    //! 压缩文件校验通过后才删除原文件，失败或被中止时保留原文件
+    if (!McCompressor::gzipFile(filePath,
+                                gzPath,
+                                backup.compressBytesPerSecond,
+                                McLogMaintainer::isShuttingDown)) {
+        MC_PRINT_ERR("compress the file: %s failure.\n", qPrintable(filePath));
+        return;
+    }
+    QFile::remove(filePath);
+    McLogFileIndex::fileRemoved(filePath);
+    McLogFileIndex::fileAdded(gzPath);
+#else
+    Q_UNUSED(backup)
+    Q_UNUSED(filePath)
+#endif
+}
+
+//! 在McLogMaintainer线程中执行：移动到备份目录并按需压缩
+void backupRolledFile(const McBackupPattern &backup, const QString &rollingPath, const QString &fileName) noexcept
+{
+    auto filePath = moveToBackup(backup, rollingPath, fileName);
+    if (filePath.isEmpty()) {
+        return;
+    }
+    //! 通知McLogDeleter等任务的文件索引，避免它们重新扫描目录
+    McLogFileIndex::fileAdded(filePath);
+    if (backup.compress) {
+        compressBackup(backup, filePath);
+    }
+}
+
+} // namespace
+
 MC_DECL_PRIVATE_DATA(McRollingFileAppender)
 QString backupDirPath;
 QString backupDirPattern;
+QString compressRate; //!< 压缩时每秒最多读取的大小，单位可以是B、KB、MB、GB，为空时不限速
+McBackupPattern backup;
+QScopedPointer<QFile> rollingLock; //!< 多进程模式下滚动文件时使用的建议锁
 MC_DECL_PRIVATE_DATA_END
 
 MC_INIT(McRollingFileAppender)
@@ -53,6 +164,7 @@ QString McRollingFileAppender::backupDirPath() const noexcept
 void McRollingFileAppender::setBackupDirPath(const QString &val) noexcept 
 {
     d->backupDirPath = Mc::toAbsolutePath(val);
+    d->backup.dirPath = d->backupDirPath;
 }
 
 QString McRollingFileAppender::backupDirPattern() const noexcept 
@@ -63,6 +175,38 @@ QString McRollingFileAppender::backupDirPattern() const noexcept
 void McRollingFileAppender::setBackupDirPattern(const QString &val) noexcept 
 {
     d->backupDirPattern = val;
+    d->backup.pattern = val;
+    d->backup.hasTime = McFileUtils::parseTimePattern(val,
+                                                      d->backup.prefix,
+                                                      d->backup.timeFormat,
+                                                      d->backup.suffix);
+}
+
+bool McRollingFileAppender::compress() const noexcept
+{
+    return d->backup.compress;
+}
+
+void McRollingFileAppender::setCompress(bool val) noexcept
+{
+#ifdef MC_DISABLE_QUAZIP
+    if (val) {
+        MC_PRINT_ERR("compress is not supported when MC_DISABLE_QUAZIP is defined\n");
+        return;
+    }
+#endif
+    d->backup.compress = val;
+}
+
+QString McRollingFileAppender::compressRate() const noexcept
+{
+    return d->compressRate;
+}
+
+void McRollingFileAppender::setCompressRate(const QString &val) noexcept
+{
+    d->compressRate = val;
+    d->backup.compressBytesPerSecond = val.trimmed().isEmpty() ? 0 : qMax<qint64>(0, McFileUtils::sizeFromString(val));
 }
 
 void McRollingFileAppender::requestNextFile() noexcept
@@ -87,10 +231,24 @@ void McRollingFileAppender::doFinished() noexcept
         setBackupDirPath("./backup/");
     if(backupDirPattern().isEmpty())
         setBackupDirPattern("%{time yyyy-MM-dd}");
+
+    recoverRollingFiles();
 }
 
 void McRollingFileAppender::tryNextFile() noexcept 
 {
+    //! 多进程模式下文件可能已被其他进程滚动，此时只需打开其他进程创建的新文件
+    if (multiProcess() && !device().isNull() && device()->isOpen()) {
+        auto file = device().staticCast<QFile>();
+        if (!McFileUtils::isSameFile(file.data(), file->fileName())) {
+            auto locked = lockRolling();
+            checkExistsFile();
+            if (locked) {
+                McFileUtils::unlockFile(d->rollingLock.data());
+            }
+            return;
+        }
+    }
     if(!isNewNextFile()) {
         return;
     }
@@ -98,6 +256,21 @@ void McRollingFileAppender::tryNextFile() noexcept
     nextFile();
 }
 
+bool McRollingFileAppender::lockRolling() noexcept
+{
+    if (d->rollingLock.isNull()) {
+        auto filePath = Mc::toAbsolutePath(lockFilePath());
+        QDir().mkpath(QFileInfo(filePath).absolutePath());
+        d->rollingLock.reset(new QFile(filePath));
+        if (!d->rollingLock->open(QIODevice::ReadWrite)) {
+            MC_PRINT_ERR("cannot open lock file: %s\n", qPrintable(filePath));
+            d->rollingLock.reset();
+            return false;
+        }
+    }
+    return McFileUtils::lockFile(d->rollingLock.data());
+}
+
 void McRollingFileAppender::nextFile() noexcept
 {
     if (device().isNull()) {
@@ -107,43 +280,68 @@ void McRollingFileAppender::nextFile() noexcept
     auto file = device().staticCast<QFile>();
 
     auto oldFilePath = file->fileName();
-    file->close();
 
-    auto backupPath = newBackupPath(oldFilePath);
-    QDir dir(backupPath);
-    if (!dir.exists() && !dir.mkpath(backupPath)) {
-        MC_PRINT_ERR("mk the backup path: %s failure.\n", qPrintable(backupPath));
+    //! 多进程模式只在滚动期间持有文件锁
+    auto locked = multiProcess() && lockRolling();
+    auto cleanup = qScopeGuard([this, locked]() {
+        if (locked) {
+            McFileUtils::unlockFile(d->rollingLock.data());
+        }
+    });
+    if (multiProcess() && !McFileUtils::isSameFile(file.data(), oldFilePath)) {
+        //! 等待锁期间其他进程已完成滚动
+        checkExistsFile();
         return;
     }
-    QFile::rename(oldFilePath, dir.absoluteFilePath(QFileInfo(oldFilePath).fileName()));
 
-    checkExistsFile();
+    file->close(); //!< 关闭时写出缓冲区中属于旧文件的消息
+    updateCrashFd();
+    closeTimeIndex();
+
+    auto rollingPath = oldFilePath;
+    auto filePath = newFilePath();
+    if (filePath == oldFilePath || multiProcess()) {
+        //! 新文件与旧文件同名时先在原目录内改名腾出文件名，只需一次同目录重命名。
+        //! 多进程模式下也需要在锁内让旧路径立即失效，其他进程才能发现文件已滚动
+        rollingPath = QStringLiteral("%1.%2.rolling").arg(oldFilePath).arg(QDateTime::currentMSecsSinceEpoch());
+        if (!QFile::rename(oldFilePath, rollingPath)) {
+            MC_PRINT_ERR("rename the file: %s failure.\n", qPrintable(oldFilePath));
+            openFile(filePath);
+            return;
+        }
+        QFile::rename(McLogTimeIndex::indexPath(oldFilePath), McLogTimeIndex::indexPath(rollingPath));
+    }
+    openFile(filePath);
+
+    //! 创建备份目录、移动和压缩文件等操作交给后台线程，写日志线程只需切换文件句柄
+    auto backup = d->backup;
+    auto fileName = QFileInfo(oldFilePath).fileName();
+    McLogMaintainer::post([backup, rollingPath, fileName]() { backupRolledFile(backup, rollingPath, fileName); });
 }
 
-QString McRollingFileAppender::newBackupPath(const QString &oldFilePath) const noexcept 
+void McRollingFileAppender::recoverRollingFiles() noexcept
 {
-    QRegularExpression re(R"((.*)%\{time (.*?)\}(.*))");
-    auto match = re.match(d->backupDirPattern);
-    
-    QDir dir(d->backupDirPath);
-    if(!match.hasMatch()) {
-        return dir.absoluteFilePath(d->backupDirPattern);
-    }
-    
-    auto list = match.capturedTexts();
-    QFileInfo fileInfo(oldFilePath);
-#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
-    auto dateTime = fileInfo.birthTime();
-    if(!dateTime.isValid()) {
-        dateTime = fileInfo.metadataChangeTime();
-    }
-#else
-    auto dateTime = fileInfo.created();
-#endif
-    if(!dateTime.isValid()) {
-        qCritical("failed get birth time of the file: %s\n", qPrintable(oldFilePath));
+    //! 文件名为"原文件名.滚动时间.rolling"
+    static const QRegularExpression re(QStringLiteral(R"(^(.+)\.(\d+)\.rolling$)"));
+    QString prefix;
+    QString timeFormat;
+    QString suffix;
+    McFileUtils::parseTimePattern(fileNamePattern(), prefix, timeFormat, suffix);
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    QDir dir(dirPath());
+    auto fileInfos = dir.entryInfoList(QStringList() << QStringLiteral("*.rolling"), QDir::Files);
+    for (const auto &fileInfo : qAsConst(fileInfos)) {
+        auto match = re.match(fileInfo.fileName());
+        if (!match.hasMatch() || !match.captured(1).startsWith(prefix) || !match.captured(1).endsWith(suffix)) {
+            continue;
+        }
+        //! 多进程模式下其他进程刚滚动的文件正等待它自己的后台线程移动，只处理一分钟以前滚动的文件
+        if (now - match.captured(2).toLongLong() < 60 * 1000) {
+            continue;
+        }
+        auto backup = d->backup;
+        auto rollingPath = fileInfo.absoluteFilePath();
+        auto fileName = match.captured(1);
+        McLogMaintainer::post([backup, rollingPath, fileName]() { backupRolledFile(backup, rollingPath, fileName); });
     }
-    return dir.absoluteFilePath(list.at(1) 
-                                + dateTime.toString(list.at(2)) 
-                                + list.at(3));
 }
@@ -106,5 +106,7 @@ bool McSizeRollingFileAppender::isNewNextFile() noexcept
     if(!file->isOpen()) {
         return false;
     }
-    return file->size() >= d->maxFileSizeBytes;
+    //! 使用写入计数代替每条消息查询文件大小。多进程模式下需要包含其他进程写入的数据
+    auto size = multiProcess() ? file->size() : bytesWritten();
+    return size >= d->maxFileSizeBytes;
 }
@@ -0,0 +1,581 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Appender/impl/McSyslogAppender.h"
+
+#ifdef Q_OS_WIN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QSysInfo>
+#include <QThread>
+
+#include "McLog/Layout/IMcLayout.h"
+#include "McLog/Utils/McLogRecord.h"
+#include "McLog/Utils/McRingBuffer.h"
+
+namespace {
+
+#ifdef Q_OS_WIN
+using NativeSocket = SOCKET;
+#else
+using NativeSocket = int;
+#endif
+
+constexpr qintptr kInvalidSocket = -1;
+
+enum class SendError { WouldBlock, Refused, Broken };
+
+void closeNativeSocket(qintptr fd) noexcept
+{
+#ifdef Q_OS_WIN
+    ::closesocket(static_cast<NativeSocket>(fd));
+#else
+    ::close(static_cast<NativeSocket>(fd));
+#endif
+}
+
+bool setNonBlocking(qintptr fd) noexcept
+{
+#ifdef Q_OS_WIN
+    u_long mode = 1;
+    return ::ioctlsocket(static_cast<NativeSocket>(fd), FIONBIO, &mode) == 0;
+#else
+    auto s = static_cast<NativeSocket>(fd);
+    auto flags = ::fcntl(s, F_GETFL, 0);
+    if (flags == -1 || ::fcntl(s, F_SETFL, flags | O_NONBLOCK) == -1) {
+        return false;
+    }
+    return ::fcntl(s, F_SETFD, FD_CLOEXEC) != -1;
+#endif
+}
+
+//! 最近一次发送失败的原因
+SendError lastSendError() noexcept
+{
+#ifdef Q_OS_WIN
+    switch (::WSAGetLastError()) {
+    case WSAEWOULDBLOCK:
+    case WSAENOBUFS:
+        return SendError::WouldBlock;
+    case WSAECONNREFUSED:
+    case WSAECONNRESET:
+        return SendError::Refused;
+    default:
+        return SendError::Broken;
+    }
+#else
+    switch (errno) {
+    case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+    case EWOULDBLOCK:
+#endif
+    case ENOBUFS:
+    case EINTR:
+        return SendError::WouldBlock;
+    case ECONNREFUSED:
+        return SendError::Refused;
+    default:
+        return SendError::Broken;
+    }
+#endif
+}
+
+qintptr openUdpSocket(const QString &host, int port) noexcept
+{
+#ifdef Q_OS_WIN
+    static const bool isWsaStarted = []() {
+        WSADATA data;
+        return ::WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!isWsaStarted) {
+        return kInvalidSocket;
+    }
+#endif
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *result = nullptr;
+    if (::getaddrinfo(host.toUtf8().constData(), QByteArray::number(port).constData(), &hints, &result)
+        != 0) {
+        MC_PRINT_ERR("cannot resolve syslog host: %s\n", qPrintable(host));
+        return kInvalidSocket;
+    }
+    qintptr fd = kInvalidSocket;
+    for (auto ai = result; ai != nullptr; ai = ai->ai_next) {
+        auto native = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+#ifdef Q_OS_WIN
+        if (native == INVALID_SOCKET) {
+            continue;
+        }
+#else
+        if (native == -1) {
+            continue;
+        }
+#endif
+        auto s = static_cast<qintptr>(native);
+        //! 连接后的UDP套接字可以直接send，也能收到对端不可达的错误
+        if (::connect(static_cast<NativeSocket>(s), ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0
+            && setNonBlocking(s)) {
+            fd = s;
+            break;
+        }
+        closeNativeSocket(s);
+    }
+    ::freeaddrinfo(result);
+    if (fd == kInvalidSocket) {
+        MC_PRINT_ERR("cannot connect to syslog host: %s:%d\n", qPrintable(host), port);
+    }
+    return fd;
+}
+
+qintptr openUnixSocket(const QString &socketPath) noexcept
+{
+#ifdef Q_OS_WIN
+    Q_UNUSED(socketPath)
+    MC_PRINT_ERR("unix datagram socket is not supported on windows\n");
+    return kInvalidSocket;
+#else
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    auto path = QFile::encodeName(socketPath);
+    if (path.isEmpty() || static_cast<size_t>(path.size()) >= sizeof(addr.sun_path)) {
+        MC_PRINT_ERR("invalid syslog socket path: %s\n", qPrintable(socketPath));
+        return kInvalidSocket;
+    }
+    memcpy(addr.sun_path, path.constData(), static_cast<size_t>(path.size()));
+    int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd == -1) {
+        return kInvalidSocket;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || !setNonBlocking(fd)) {
+        //! syslog守护进程未启动时会一直失败，只在调用方节流后重试
+        ::close(fd);
+        return kInvalidSocket;
+    }
+    return fd;
+#endif
+}
+
+int facilityCode(const QString &val) noexcept
+{
+    static const QHash<QString, int> names{{"kern", 0},     {"user", 1},    {"mail", 2},
+                                           {"daemon", 3},   {"auth", 4},    {"syslog", 5},
+                                           {"lpr", 6},      {"news", 7},    {"uucp", 8},
+                                           {"cron", 9},     {"authpriv", 10}, {"ftp", 11},
+                                           {"local0", 16},  {"local1", 17}, {"local2", 18},
+                                           {"local3", 19},  {"local4", 20}, {"local5", 21},
+                                           {"local6", 22},  {"local7", 23}};
+    auto name = val.trimmed().toLower();
+    auto itr = names.constFind(name);
+    if (itr != names.constEnd()) {
+        return itr.value();
+    }
+    bool ok = false;
+    auto code = name.toInt(&ok);
+    if (ok && code >= 0 && code <= 23) {
+        return code;
+    }
+    MC_PRINT_ERR("unknown syslog facility: %s. use user\n", qPrintable(val));
+    return 1;
+}
+
+int severity(QtMsgType type) noexcept
+{
+    switch (type) {
+    case QtDebugMsg:
+        return 7;
+    case QtInfoMsg:
+        return 6;
+    case QtWarningMsg:
+        return 4;
+    case QtCriticalMsg:
+        return 3;
+    case QtFatalMsg:
+        return 2;
+    }
+    return 5;
+}
+
+//! RFC 5424的头部字段只允许可打印的ASCII字符，为空时使用NILVALUE
+QByteArray headerField(const QByteArray &val, int maxLength) noexcept
+{
+    QByteArray field = val.left(maxLength);
+    for (auto &c : field) {
+        if (c < 33 || c > 126) {
+            c = '_';
+        }
+    }
+    return field.isEmpty() ? QByteArrayLiteral("-") : field;
+}
+
+} // namespace
+
+MC_DECL_PRIVATE_DATA(McSyslogAppender)
+IMcLayoutPtr layout;
+QString protocol{"udp"};
+QString host{"127.0.0.1"};
+int port{514};
+QString socketPath{"/dev/log"};
+QString facility{"user"};
+int facilityCode{1};
+QString appName;
+QString hostName;
+int maxDatagramSize{2048}; //!< RFC 5426建议接收方至少支持2048字节
+int queueCapacity{8192};
+QScopedPointer<McMpscRingBuffer<McLogRecord>> queue;
+QAtomicInteger<bool> isDrainScheduled{false};
+std::atomic<quint64> droppedCount{0};
+qintptr socket{kInvalidSocket};
+qint64 lastConnectMsecs{0};
+QByteArray headerMiddle;              //!< " HOSTNAME APP-NAME PROCID "
+QHash<QByteArray, QByteArray> msgIds; //!< category对应的MSGID，按内容查找
+MC_DECL_PRIVATE_DATA_END
+
+MC_INIT(McSyslogAppender)
+MC_REGISTER_BEAN_FACTORY(McSyslogAppender)
+MC_INIT_END
+
+McSyslogAppender::McSyslogAppender()
+{
+    MC_NEW_PRIVATE_DATA(McSyslogAppender);
+}
+
+McSyslogAppender::~McSyslogAppender()
+{
+    //! 此时已不会再有生产者，发出剩余的记录
+    if (!d->queue.isNull()) {
+        while (sendQueued(d->queue->capacity()) > 0) {
+        }
+    }
+    closeSocket();
+}
+
+IMcLayoutPtr McSyslogAppender::layout() const noexcept
+{
+    return d->layout;
+}
+
+void McSyslogAppender::setLayout(IMcLayoutConstPtrRef val) noexcept
+{
+    d->layout = val;
+}
+
+QString McSyslogAppender::protocol() const noexcept
+{
+    return d->protocol;
+}
+
+void McSyslogAppender::setProtocol(const QString &val) noexcept
+{
+    d->protocol = val.trimmed().toLower();
+}
+
+QString McSyslogAppender::host() const noexcept
+{
+    return d->host;
+}
+
+void McSyslogAppender::setHost(const QString &val) noexcept
+{
+    d->host = val;
+}
+
+int McSyslogAppender::port() const noexcept
+{
+    return d->port;
+}
+
+void McSyslogAppender::setPort(int val) noexcept
+{
+    d->port = val;
+}
+
+QString McSyslogAppender::socketPath() const noexcept
+{
+    return d->socketPath;
+}
+
+void McSyslogAppender::setSocketPath(const QString &val) noexcept
+{
+    d->socketPath = val;
+}
+
+QString McSyslogAppender::facility() const noexcept
+{
+    return d->facility;
+}
+
+void McSyslogAppender::setFacility(const QString &val) noexcept
+{
+    d->facility = val;
+    d->facilityCode = facilityCode(val);
+}
+
+QString McSyslogAppender::appName() const noexcept
+{
+    return d->appName;
+}
+
+void McSyslogAppender::setAppName(const QString &val) noexcept
+{
+    d->appName = val;
+}
+
+QString McSyslogAppender::hostName() const noexcept
+{
+    return d->hostName;
+}
+
+void McSyslogAppender::setHostName(const QString &val) noexcept
+{
+    d->hostName = val;
+}
+
+int McSyslogAppender::maxDatagramSize() const noexcept
+{
+    return d->maxDatagramSize;
+}
+
+void McSyslogAppender::setMaxDatagramSize(int val) noexcept
+{
+    d->maxDatagramSize = val;
+}
+
+int McSyslogAppender::queueCapacity() const noexcept
+{
+    return d->queueCapacity;
+}
+
+void McSyslogAppender::setQueueCapacity(int val) noexcept
+{
+    d->queueCapacity = val;
+}
+
+quint64 McSyslogAppender::droppedCount() const noexcept
+{
+    return d->droppedCount.load(std::memory_order_relaxed);
+}
+
+void McSyslogAppender::append(QtMsgType type,
+                              const QMessageLogContext &context,
+                              const QString &str) noexcept
+{
+    if (!types().contains(type) || d->queue.isNull()) {
+        return;
+    }
+    auto record = McLogRecord::capture(type, context, str);
+    if (!d->queue->tryPush(std::move(record))) {
+        //! 网络日志不允许阻塞调用线程，队列已满时直接丢弃
+        d->droppedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    scheduleDrain();
+}
+
+void McSyslogAppender::doFinished() noexcept
+{
+    super::doFinished();
+
+    if (d->maxDatagramSize < 480) {
+        d->maxDatagramSize = 480; //!< RFC 5426要求接收方至少支持480字节
+    }
+    auto hostName = d->hostName.isEmpty() ? QSysInfo::machineHostName() : d->hostName;
+    auto appName = d->appName.isEmpty() ? QCoreApplication::applicationName() : d->appName;
+    d->headerMiddle = ' ' + headerField(hostName.toUtf8(), 255) + ' ' + headerField(appName.toUtf8(), 48)
+                      + ' ' + headerField(QByteArray::number(QCoreApplication::applicationPid()), 128)
+                      + ' ';
+    d->queue.reset(new McMpscRingBuffer<McLogRecord>(d->queueCapacity));
+}
+
+void McSyslogAppender::customEvent(QEvent *event)
+{
+    if (event->type() == QEvent::User + 1) {
+        drainQueue();
+    }
+}
+
+void McSyslogAppender::scheduleDrain() noexcept
+{
+    if (d->isDrainScheduled.fetchAndStoreAcquire(true)) {
+        return;
+    }
+    qApp->postEvent(this, new QEvent(static_cast<QEvent::Type>(QEvent::User + 1)));
+}
+
+void McSyslogAppender::drainQueue() noexcept
+{
+    d->isDrainScheduled.storeRelease(false);
+    sendQueued(d->queue->capacity());
+    if (!d->queue->isEmpty()) {
+        scheduleDrain();
+    }
+}
+
+int McSyslogAppender::sendQueued(int maxCount) noexcept
+{
+    if (d->queue->isEmpty()) {
+        return 0;
+    }
+    if (!ensureSocket()) {
+        auto count = d->queue->drain([](const McLogRecord &) {}, maxCount);
+        d->droppedCount.fetch_add(static_cast<quint64>(count), std::memory_order_relaxed);
+        return count;
+    }
+    QVector<QByteArray> datagrams;
+    auto count = d->queue->drain(
+        [this, &datagrams](const McLogRecord &record) { datagrams.append(buildMessage(record)); },
+        maxCount);
+    sendDatagrams(datagrams);
+    return count;
+}
+
+void McSyslogAppender::sendDatagrams(const QVector<QByteArray> &datagrams) noexcept
+{
+    int offset = 0;
+    auto drop = [this, &datagrams, &offset](int count) {
+        d->droppedCount.fetch_add(static_cast<quint64>(count), std::memory_order_relaxed);
+        offset += count;
+    };
+    while (offset < datagrams.size() && d->socket != kInvalidSocket) {
+#ifdef Q_OS_LINUX
+        constexpr int kMaxBatch = 64;
+        mmsghdr messages[kMaxBatch];
+        iovec iovs[kMaxBatch];
+        auto batchSize = qMin(kMaxBatch, static_cast<int>(datagrams.size() - offset));
+        for (int i = 0; i < batchSize; ++i) {
+            auto &datagram = datagrams.at(offset + i);
+            iovs[i].iov_base = const_cast<char *>(datagram.constData());
+            iovs[i].iov_len = static_cast<size_t>(datagram.size());
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_iov = &iovs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        auto sent = ::sendmmsg(static_cast<NativeSocket>(d->socket), messages, static_cast<unsigned>(batchSize), 0);
+        if (sent > 0) {
+            offset += sent;
+            continue;
+        }
+#else
+        auto &datagram = datagrams.at(offset);
+        auto sent = ::send(static_cast<NativeSocket>(d->socket),
+                           datagram.constData(),
+                           static_cast<int>(datagram.size()),
+                           0);
+        if (sent >= 0) {
+            ++offset;
+            continue;
+        }
+#endif
+        switch (lastSendError()) {
+        case SendError::WouldBlock:
+            //! 发送缓冲区已满，丢弃本批剩余的记录而不是等待
+            drop(datagrams.size() - offset);
+            break;
+        case SendError::Refused:
+            //! 对端暂时没有监听，这一条没有发出，后面的继续尝试
+            drop(1);
+            break;
+        case SendError::Broken:
+            closeSocket();
+            break;
+        }
+    }
+    if (offset < datagrams.size()) {
+        drop(datagrams.size() - offset);
+    }
+}
+
+bool McSyslogAppender::ensureSocket() noexcept
+{
+    if (d->socket != kInvalidSocket) {
+        return true;
+    }
+    //! 连接失败后每秒最多重试一次，期间的记录直接丢弃
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    if (now - d->lastConnectMsecs < 1000) {
+        return false;
+    }
+    d->lastConnectMsecs = now;
+    if (d->protocol == QLatin1String("unix")) {
+        d->socket = openUnixSocket(d->socketPath);
+    } else {
+        d->socket = openUdpSocket(d->host, d->port);
+    }
+    return d->socket != kInvalidSocket;
+}
+
+void McSyslogAppender::closeSocket() noexcept
+{
+    if (d->socket == kInvalidSocket) {
+        return;
+    }
+    closeNativeSocket(d->socket);
+    d->socket = kInvalidSocket;
+}
+
+QByteArray McSyslogAppender::buildMessage(const McLogRecord &record) noexcept
+{
+    auto category = QByteArray::fromRawData(record.category, static_cast<int>(qstrlen(record.category)));
+    auto itr = d->msgIds.constFind(category);
+    if (itr == d->msgIds.constEnd()) {
+        QByteArray key(category.constData(), category.size());
+        itr = d->msgIds.insert(key, headerField(key, 32));
+    }
+    auto text = d->layout.isNull() ? record.message : d->layout->formatRecord(record);
+
+    QByteArray message;
+    message.reserve(d->headerMiddle.size() + itr.value().size() + text.size() + 40);
+    message.append('<');
+    message.append(QByteArray::number(d->facilityCode * 8 + severity(record.type)));
+    message.append(">1 ");
+    message.append(
+        QDateTime::fromMSecsSinceEpoch(record.msecsSinceEpoch).toUTC().toString(Qt::ISODateWithMs).toLatin1());
+    message.append(d->headerMiddle);
+    message.append(itr.value());
+    message.append(" - ");
+    message.append(text.toUtf8());
+    if (message.size() > d->maxDatagramSize) {
+        //! 超长的记录截断，不拆开UTF-8的多字节字符
+        auto size = d->maxDatagramSize;
+        while (size > 0 && (static_cast<uchar>(message.at(size)) & 0xC0) == 0x80) {
+            --size;
+        }
+        message.truncate(size);
+    }
+    return message;
+}
@@ -32,6 +32,7 @@
 #include "McLog/Logger/impl/McLogger.h"
 #include "McLog/Appender/impl/McConsoleAppender.h"
 #include "McLog/Appender/impl/McSizeRollingFileAppender.h"
+#include "McLog/Appender/impl/McSyslogAppender.h"
 
 McSettingConfigurator::McSettingConfigurator() 
 {
@@ -110,15 +111,25 @@ QList<IMcConfigurableAppenderPtr> McSettingConfigurator::configAppenders(QSettin
             }
             appender->setThreshold(threshold);
             appender->setImmediateFlush(settings.value("immediateFlush", false).toBool());
+            appender->setDurability(settings.value("durability", "none").toString());
+            appender->setFsyncInterval(settings.value("fsyncInterval", 1000).toInt());
+            appender->setMultiProcess(settings.value("multiProcess", false).toBool());
+            appender->setQueueCapacity(settings.value("queueCapacity", 8192).toInt());
+            appender->setOverflowPolicy(settings.value("overflowPolicy", "block").toString());
+            appender->setBlockTimeout(settings.value("blockTimeout", -1).toInt());
+            appender->setDropThreshold(settings.value("dropThreshold", "warn").toString());
+            appender->setSampleRate(settings.value("sampleRate", 10).toInt());
+            appender->setStatsInterval(settings.value("statsInterval", 0).toInt());
             appender->setMaxFileSize(settings.value("maxFileSize", "10MB").toString());
             appender->setBackupDirPath(settings.value("backupDirPath", "").toString());
             appender->setBackupDirPattern(settings.value("backupDirPattern", "").toString());
+            appender->setCompress(settings.value("compress", false).toBool());
+            appender->setCompressRate(settings.value("compressRate", "").toString());
             appender->setDirPath(settings.value("dirPath", "").toString());
             appender->setFileNamePattern(settings.value("fileNamePattern").toString());
+            appender->setIndexInterval(settings.value("indexInterval", 0).toInt());
 
-            appender->finished();
-            appender->moveToThread(thread());
-            appender->threadFinished();
+            finishAppender(appender.data());
 
             appenders.append(appender);
         }else if(appenderName == "console") {
@@ -134,9 +145,30 @@ QList<IMcConfigurableAppenderPtr> McSettingConfigurator::configAppenders(QSettin
             appender->setThreshold(threshold);
             appender->setImmediateFlush(settings.value("immediateFlush", false).toBool());
 
-            appender->finished();
-            appender->moveToThread(thread());
-            appender->threadFinished();
+            finishAppender(appender.data());
+
+            appenders.append(appender);
+        }else if(appenderName == "syslog") {
+            McSyslogAppenderPtr appender = McSyslogAppenderPtr::create();
+            
+            QString threshold;
+            auto value = settings.value("threshold", "");
+            if(value.type() == QVariant::String) {
+                threshold = value.toString();
+            }else{
+                threshold = value.toStringList().join(',');
+            }
+            appender->setThreshold(threshold);
+            appender->setProtocol(settings.value("protocol", "udp").toString());
+            appender->setHost(settings.value("host", "127.0.0.1").toString());
+            appender->setPort(settings.value("port", 514).toInt());
+            appender->setSocketPath(settings.value("socketPath", "/dev/log").toString());
+            appender->setFacility(settings.value("facility", "user").toString());
+            appender->setAppName(settings.value("appName", "").toString());
+            appender->setHostName(settings.value("hostName", "").toString());
+            appender->setMaxDatagramSize(settings.value("maxDatagramSize", 2048).toInt());
+
+            finishAppender(appender.data());
 
             appenders.append(appender);
         }
@@ -146,3 +178,11 @@ QList<IMcConfigurableAppenderPtr> McSettingConfigurator::configAppenders(QSettin
     
     return appenders;
 }
+
+void McSettingConfigurator::finishAppender(McAbstractAppender *appender) noexcept
+{
+    appender->finished();
+    appender->moveToThread(thread());
+    appender->threadFinished();
+    appender->allFinished(); //!< 线程尚未启动，直接调用，创建有界的消息队列
+}
@@ -0,0 +1,386 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Device/McMmapFileDevice.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QLockFile>
+#include <QtConcurrent>
+
+#include "McLog/Utils/McFileUtils.h"
+
+namespace {
+
+//! 段文件写入期间持有的锁文件的后缀，既标记该文件由McMmapFileDevice创建，也表明写入它的进程是否还在运行
+const QString kLockSuffix = QStringLiteral(".lock");
+
+struct McMmapSegment
+{
+    QSharedPointer<QFile> file;
+    QSharedPointer<QLockFile> lock;
+    uchar *data{nullptr};
+};
+
+QSharedPointer<QLockFile> lockSegment(const QString &filePath) noexcept
+{
+    auto lock = QSharedPointer<QLockFile>::create(filePath + kLockSuffix);
+    //! 段的写入时间可能很长，只按进程是否存在判断锁是否失效
+    lock->setStaleLockTime(0);
+    if (!lock->tryLock(0)) {
+        return QSharedPointer<QLockFile>();
+    }
+    return lock;
+}
+
+McMmapSegment createSegment(const QString &filePath, qint64 size) noexcept
+{
+    McMmapSegment segment;
+    auto lock = lockSegment(filePath);
+    if (lock.isNull()) {
+        MC_PRINT_ERR("cannot lock file '%s' for write!!!\n", qPrintable(filePath));
+        return segment;
+    }
+    auto file = QSharedPointer<QFile>::create(filePath);
+    if (!file->open(QIODevice::ReadWrite)) {
+        MC_PRINT_ERR("error open file '%s' for write!!!\n", qPrintable(filePath));
+        return segment;
+    }
+    if (!McFileUtils::preallocate(file.data(), size)) {
+        MC_PRINT_ERR("cannot preallocate %lld bytes for file: %s\n", size, qPrintable(filePath));
+        file->close();
+        file->remove();
+        return segment;
+    }
+    segment.data = file->map(0, size);
+    if (segment.data == nullptr) {
+        MC_PRINT_ERR("cannot map file: %s\n", qPrintable(filePath));
+        file->close();
+        file->remove();
+        return segment;
+    }
+    segment.file = file;
+    segment.lock = lock;
+    return segment;
+}
+
+//! 解除映射并截断为实际长度，length为-1表示丢弃该段
+void finishSegment(const McMmapSegment &segment, qint64 length) noexcept
+{
+    if (segment.file.isNull()) {
+        return;
+    }
+    segment.file->unmap(segment.data);
+    if (length > 0) {
+        segment.file->resize(length);
+        segment.file->close();
+    } else {
+        segment.file->close();
+        segment.file->remove();
+    }
+    //! 截断完成后才释放锁，否则其他进程的recover可能处理到未截断的段
+    segment.lock->unlock();
+}
+
+//! 从末尾向前查找最后一个非0字节，返回实际长度
+qint64 realLength(QFile &file) noexcept
+{
+    constexpr qint64 chunkSize = 64 * 1024;
+    auto end = file.size();
+    while (end > 0) {
+        auto begin = qMax<qint64>(0, end - chunkSize);
+        file.seek(begin);
+        auto chunk = file.read(end - begin);
+        if (chunk.size() != end - begin) {
+            return -1;
+        }
+        for (auto i = chunk.size() - 1; i >= 0; --i) {
+            if (chunk.at(i) != '\0') {
+                return begin + i + 1;
+            }
+        }
+        end = begin;
+    }
+    return 0;
+}
+
+} // namespace
+
+MC_INIT(McMmapFileDevice)
+MC_INIT_END
+
+MC_DECL_PRIVATE_DATA(McMmapFileDevice)
+QString dirPath;
+QString fileNamePattern;
+bool hasFileTime{false};
+QString filePrefix;
+QString fileTimeFormat;
+QString fileSuffix;
+qint64 segmentSize{64 * 1024 * 1024};
+McMmapSegment current;
+QFuture<McMmapSegment> next; //!< 后台提前创建的下一段
+QList<QFuture<void>> finishing; //!< 后台截断中的已写满的段
+QAtomicInteger<qint64> tail{0};
+MC_DECL_PRIVATE_DATA_END
+
+McMmapFileDevice::McMmapFileDevice(QObject *parent) noexcept
+    : QIODevice(parent)
+{
+    MC_NEW_PRIVATE_DATA(McMmapFileDevice);
+}
+
+McMmapFileDevice::~McMmapFileDevice()
+{
+    close();
+}
+
+QString McMmapFileDevice::dirPath() const noexcept
+{
+    return d->dirPath;
+}
+
+void McMmapFileDevice::setDirPath(const QString &val) noexcept
+{
+    d->dirPath = val;
+}
+
+QString McMmapFileDevice::fileNamePattern() const noexcept
+{
+    return d->fileNamePattern;
+}
+
+void McMmapFileDevice::setFileNamePattern(const QString &val) noexcept
+{
+    d->fileNamePattern = val;
+    d->hasFileTime = McFileUtils::parseTimePattern(val, d->filePrefix, d->fileTimeFormat, d->fileSuffix);
+}
+
+qint64 McMmapFileDevice::segmentSize() const noexcept
+{
+    return d->segmentSize;
+}
+
+void McMmapFileDevice::setSegmentSize(qint64 val) noexcept
+{
+    d->segmentSize = val;
+}
+
+QString McMmapFileDevice::currentFilePath() const noexcept
+{
+    return d->current.file.isNull() ? QString() : d->current.file->fileName();
+}
+
+qint64 McMmapFileDevice::tail() const noexcept
+{
+    return d->tail.loadAcquire();
+}
+
+bool McMmapFileDevice::open(OpenMode mode)
+{
+    if (mode.testFlag(QIODevice::ReadOnly)) {
+        setErrorString("McMmapFileDevice is write only");
+        return false;
+    }
+    if (d->segmentSize <= 0) {
+        setErrorString("segment size must be greater than 0");
+        return false;
+    }
+    QDir dir(d->dirPath);
+    if (!dir.exists() && !dir.mkpath(d->dirPath)) {
+        setErrorString(QStringLiteral("cannot create dir: %1").arg(d->dirPath));
+        return false;
+    }
+    recover(d->dirPath, d->fileNamePattern);
+
+    d->current = createSegment(newFilePath(), d->segmentSize);
+    if (d->current.data == nullptr) {
+        setErrorString("cannot create the first segment");
+        return false;
+    }
+    d->tail.storeRelease(0);
+    prepareNext();
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+void McMmapFileDevice::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+    QIODevice::close();
+
+    finishSegment(d->current, d->tail.loadAcquire());
+    d->current = McMmapSegment();
+    d->tail.storeRelease(0);
+    if (!d->next.isCanceled()) {
+        finishSegment(d->next.result(), -1);
+    }
+    d->next = QFuture<McMmapSegment>();
+    //! 保证close返回时所有段都已截断为实际长度
+    for (auto &future : d->finishing) {
+        future.waitForFinished();
+    }
+    d->finishing.clear();
+}
+
+bool McMmapFileDevice::isSequential() const
+{
+    return true;
+}
+
+void McMmapFileDevice::recover(const QString &dirPath, const QString &fileNamePattern) noexcept
+{
+    QString prefix;
+    QString timeFormat;
+    QString suffix;
+    McFileUtils::parseTimePattern(fileNamePattern, prefix, timeFormat, suffix);
+    QDir dir(dirPath);
+    auto fileInfos = dir.entryInfoList(QDir::Files);
+    for (const auto &fileInfo : qAsConst(fileInfos)) {
+        auto fileName = fileInfo.fileName();
+        //! 重名时会在末尾追加序号，所以后缀不要求出现在末尾
+        if (!fileName.startsWith(prefix) || (!suffix.isEmpty() && !fileName.contains(suffix))
+            || fileName.endsWith(kLockSuffix)) {
+            continue;
+        }
+        //! 只处理McMmapFileDevice创建且写入进程已经退出的段。
+        //! 没有锁文件的是已正常截断的段或其他程序的文件，锁仍被持有的是其他进程正在写入的段
+        auto filePath = fileInfo.absoluteFilePath();
+        if (!QFile::exists(filePath + kLockSuffix)) {
+            continue;
+        }
+        auto lock = lockSegment(filePath);
+        if (lock.isNull()) {
+            continue;
+        }
+        QFile file(filePath);
+        if (file.size() == 0 || !file.open(QIODevice::ReadWrite)) {
+            continue;
+        }
+        char last = 0;
+        if (!file.seek(file.size() - 1) || !file.getChar(&last) || last != '\0') {
+            continue; //!< 已正常截断
+        }
+        auto length = realLength(file);
+        if (length < 0) {
+            continue;
+        }
+        file.close();
+        if (length == 0) {
+            file.remove();
+        } else {
+            file.resize(length);
+        }
+    }
+}
+
+qint64 McMmapFileDevice::readData(char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+qint64 McMmapFileDevice::writeData(const char *data, qint64 maxSize)
+{
+    qint64 written = 0;
+    while (written < maxSize) {
+        if (d->current.data == nullptr) {
+            setErrorString("no segment to write");
+            return written > 0 ? written : -1;
+        }
+        auto tail = d->tail.loadRelaxed();
+        auto space = d->segmentSize - tail;
+        auto count = maxSize - written;
+        if (count > space) {
+            //! 在最后一个换行处切分，避免把一条日志拆到两个文件中
+            count = 0;
+            for (auto i = space; i > 0; --i) {
+                if (data[written + i - 1] == '\n') {
+                    count = i;
+                    break;
+                }
+            }
+            if (count == 0 && tail == 0) {
+                count = space; //!< 单条日志比一个段还大，只能拆分
+            }
+            if (count == 0) {
+                if (!roll()) {
+                    return written > 0 ? written : -1;
+                }
+                continue;
+            }
+        }
+        memcpy(d->current.data + tail, data + written, static_cast<size_t>(count));
+        d->tail.storeRelease(tail + count);
+        written += count;
+    }
+    return written;
+}
+
+QString McMmapFileDevice::newFilePath() const noexcept
+{
+    QDir dir(d->dirPath);
+    QString fileName = d->fileNamePattern;
+    if (d->hasFileTime) {
+        fileName = d->filePrefix + QDateTime::currentDateTime().toString(d->fileTimeFormat) + d->fileSuffix;
+    }
+    auto filePath = dir.absoluteFilePath(fileName);
+    for (int i = 1; QFile::exists(filePath); ++i) {
+        filePath = dir.absoluteFilePath(QStringLiteral("%1.%2").arg(fileName).arg(i));
+    }
+    return filePath;
+}
+
+void McMmapFileDevice::prepareNext() noexcept
+{
+    //! 文件名在本线程中确定，保证与当前段不会重名
+    auto filePath = newFilePath();
+    QFile placeholder(filePath);
+    placeholder.open(QIODevice::WriteOnly);
+    placeholder.close();
+    d->next = QtConcurrent::run(createSegment, filePath, d->segmentSize);
+}
+
+bool McMmapFileDevice::roll() noexcept
+{
+    auto finished = d->current;
+    auto length = d->tail.loadRelaxed();
+    //! 截断和关闭放到后台，写入线程只切换映射
+    for (int i = d->finishing.size() - 1; i >= 0; --i) {
+        if (d->finishing.at(i).isFinished()) {
+            d->finishing.removeAt(i);
+        }
+    }
+    d->finishing.append(QtConcurrent::run(finishSegment, finished, length));
+
+    d->current = d->next.result(); //!< 通常早已准备好，只有写满一段比创建一段还快时才会等待
+    d->tail.storeRelease(0);
+    if (d->current.data == nullptr) {
+        d->current = createSegment(newFilePath(), d->segmentSize);
+    }
+    prepareNext();
+    return d->current.data != nullptr;
+}
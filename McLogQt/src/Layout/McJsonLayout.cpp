@@ -0,0 +1,281 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Layout/impl/McJsonLayout.h"
+
+#include <QDateTime>
+#include <QVector>
+
+#include "McLog/Utils/McMessagePattern.h"
+
+namespace {
+
+enum class JsonField { Time, Level, Category, Tid, File, Line, Function, Message };
+
+//! 写入带引号的JSON字符串，不需要转义的片段整段追加
+void appendJsonString(QString &out, QStringView str) noexcept
+{
+    static const char hex[] = "0123456789abcdef";
+    out += QLatin1Char('"');
+    qsizetype begin = 0;
+    for (qsizetype i = 0; i < str.size(); ++i) {
+        auto c = str.at(i).unicode();
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out += str.mid(begin, i - begin);
+        begin = i + 1;
+        switch (c) {
+        case '"':
+            out += QLatin1String("\\\"");
+            break;
+        case '\\':
+            out += QLatin1String("\\\\");
+            break;
+        case '\n':
+            out += QLatin1String("\\n");
+            break;
+        case '\r':
+            out += QLatin1String("\\r");
+            break;
+        case '\t':
+            out += QLatin1String("\\t");
+            break;
+        case '\b':
+            out += QLatin1String("\\b");
+            break;
+        case '\f':
+            out += QLatin1String("\\f");
+            break;
+        default:
+            out += QLatin1String("\\u00");
+            out += QLatin1Char(hex[(c >> 4) & 0xF]);
+            out += QLatin1Char(hex[c & 0xF]);
+            break;
+        }
+    }
+    out += str.mid(begin);
+    out += QLatin1Char('"');
+}
+
+void appendJsonString(QString &out, const char *str) noexcept
+{
+    if (str == nullptr) {
+        out += QLatin1String("null");
+        return;
+    }
+    appendJsonString(out, QString::fromUtf8(str));
+}
+
+void appendKey(QString &out, QLatin1String key, bool &isFirst) noexcept
+{
+    if (!isFirst) {
+        out += QLatin1Char(',');
+    }
+    isFirst = false;
+    out += QLatin1Char('"');
+    out += key;
+    out += QLatin1String("\":");
+}
+
+QLatin1String levelName(QtMsgType type) noexcept
+{
+    switch (type) {
+    case QtDebugMsg:
+        return QLatin1String("debug");
+    case QtInfoMsg:
+        return QLatin1String("info");
+    case QtWarningMsg:
+        return QLatin1String("warning");
+    case QtCriticalMsg:
+        return QLatin1String("critical");
+    case QtFatalMsg:
+        return QLatin1String("fatal");
+    }
+    return QLatin1String("unknown");
+}
+
+} // namespace
+
+MC_DECL_PRIVATE_DATA(McJsonLayout)
+QList<QString> fields{"time", "level", "category", "tid", "file", "line", "function", "message"};
+QVector<JsonField> compiledFields{JsonField::Time,
+                                  JsonField::Level,
+                                  JsonField::Category,
+                                  JsonField::Tid,
+                                  JsonField::File,
+                                  JsonField::Line,
+                                  JsonField::Function,
+                                  JsonField::Message};
+QString timeFormat; //!< 为空时使用带毫秒的ISO 8601格式
+bool includeMdc{true};
+MC_PADDING_CLANG(7)
+MC_DECL_PRIVATE_DATA_END
+
+MC_INIT(McJsonLayout)
+MC_REGISTER_BEAN_FACTORY(McJsonLayout)
+MC_INIT_END
+
+McJsonLayout::McJsonLayout()
+{
+    MC_NEW_PRIVATE_DATA(McJsonLayout);
+}
+
+McJsonLayout::~McJsonLayout()
+{
+}
+
+QList<QString> McJsonLayout::fields() const noexcept
+{
+    return d->fields;
+}
+
+void McJsonLayout::setFields(const QList<QString> &val) noexcept
+{
+    static const QHash<QString, JsonField> names{{"time", JsonField::Time},
+                                                 {"level", JsonField::Level},
+                                                 {"category", JsonField::Category},
+                                                 {"tid", JsonField::Tid},
+                                                 {"file", JsonField::File},
+                                                 {"line", JsonField::Line},
+                                                 {"function", JsonField::Function},
+                                                 {"message", JsonField::Message}};
+    d->fields = val;
+    d->compiledFields.clear();
+    for (auto &field : val) {
+        auto itr = names.constFind(field.trimmed().toLower());
+        if (itr == names.constEnd()) {
+            MC_PRINT_ERR("unknown json field: %s\n", qPrintable(field));
+            continue;
+        }
+        d->compiledFields.append(itr.value());
+    }
+}
+
+QString McJsonLayout::timeFormat() const noexcept
+{
+    return d->timeFormat;
+}
+
+void McJsonLayout::setTimeFormat(const QString &val) noexcept
+{
+    d->timeFormat = val;
+}
+
+bool McJsonLayout::includeMdc() const noexcept
+{
+    return d->includeMdc;
+}
+
+void McJsonLayout::setIncludeMdc(bool val) noexcept
+{
+    d->includeMdc = val;
+}
+
+QString McJsonLayout::format(QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept
+{
+    return formatJson(type,
+                      context,
+                      QDateTime::currentMSecsSinceEpoch(),
+                      McPrivate::currentThreadId(),
+                      str,
+                      d->includeMdc ? McLogMdc::entries() : McLogMdc::Entries());
+}
+
+QString McJsonLayout::formatRecord(const McLogRecord &record) noexcept
+{
+    return formatJson(record.type,
+                      record.context(),
+                      record.msecsSinceEpoch,
+                      record.threadId,
+                      record.message,
+                      record.mdc);
+}
+
+QString McJsonLayout::formatJson(QtMsgType type,
+                                 const QMessageLogContext &context,
+                                 qint64 msecsSinceEpoch,
+                                 qint64 threadId,
+                                 const QString &message,
+                                 const McLogMdc::Entries &mdc) const noexcept
+{
+    QString out;
+    out.reserve(message.size() + 160);
+    out += QLatin1Char('{');
+    bool isFirst = true;
+    for (auto field : qAsConst(d->compiledFields)) {
+        switch (field) {
+        case JsonField::Time: {
+            appendKey(out, QLatin1String("time"), isFirst);
+            auto dateTime = QDateTime::fromMSecsSinceEpoch(msecsSinceEpoch);
+            appendJsonString(out,
+                             d->timeFormat.isEmpty() ? dateTime.toString(Qt::ISODateWithMs)
+                                                     : dateTime.toString(d->timeFormat));
+            break;
+        }
+        case JsonField::Level:
+            appendKey(out, QLatin1String("level"), isFirst);
+            out += QLatin1Char('"');
+            out += levelName(type);
+            out += QLatin1Char('"');
+            break;
+        case JsonField::Category:
+            appendKey(out, QLatin1String("category"), isFirst);
+            appendJsonString(out, context.category);
+            break;
+        case JsonField::Tid:
+            appendKey(out, QLatin1String("tid"), isFirst);
+            out += QString::number(threadId);
+            break;
+        case JsonField::File:
+            appendKey(out, QLatin1String("file"), isFirst);
+            appendJsonString(out, context.file);
+            break;
+        case JsonField::Line:
+            appendKey(out, QLatin1String("line"), isFirst);
+            out += QString::number(context.line);
+            break;
+        case JsonField::Function:
+            appendKey(out, QLatin1String("function"), isFirst);
+            appendJsonString(out, context.function);
+            break;
+        case JsonField::Message:
+            appendKey(out, QLatin1String("message"), isFirst);
+            appendJsonString(out, message);
+            break;
+        }
+    }
+    if (d->includeMdc) {
+        for (auto &entry : mdc) {
+            if (!isFirst) {
+                out += QLatin1Char(',');
+            }
+            isFirst = false;
+            appendJsonString(out, entry.first);
+            out += QLatin1Char(':');
+            appendJsonString(out, entry.second);
+        }
+    }
+    out += QLatin1Char('}');
+    return out;
+}
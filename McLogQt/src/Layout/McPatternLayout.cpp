@@ -62,6 +62,25 @@ QString McPatternLayout::format(QtMsgType type, const QMessageLogContext &contex
     return McPrivate::format(d->messagePattern, type, context, str);
 }
 
+QString McPatternLayout::formatRecord(const McLogRecord &record) noexcept
+{
+    return McPrivate::format(d->messagePattern, record);
+}
+
+void McPatternLayout::formatRecordUtf8(const McLogRecord &record, QByteArray &out) noexcept
+{
+    McPrivate::formatUtf8(d->messagePattern, record, out);
+}
+
+bool McPatternLayout::requiresDeferredFormat() const noexcept
+{
+#ifdef QLOGGING_HAVE_BACKTRACE
+    return !d->messagePattern->backtraceArgs.isEmpty();
+#else
+    return false;
+#endif
+}
+
 void McPatternLayout::finished() noexcept 
 {
 }
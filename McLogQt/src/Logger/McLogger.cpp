@@ -81,3 +81,16 @@ void McLogger::log(QtMsgType type, const QMessageLogContext &context, const QStr
         appender->append(type, context, str);
     }
 }
+
+QList<QtMsgType> McLogger::types() const noexcept
+{
+    QList<QtMsgType> types;
+    for (auto appender : d->appenders) {
+        for (auto type : appender->types()) {
+            if (!types.contains(type)) {
+                types.append(type);
+            }
+        }
+    }
+    return types;
+}
@@ -23,10 +23,31 @@
  */
 #include "McLog/McLogManager.h"
 
+#include <array>
+#include <atomic>
+
+#include <QLoggingCategory>
+
 #include "McLog/Repository/IMcLoggerRepository.h"
 #include "McLog/Logger/IMcLogger.h"
+#include "McLog/Utils/McLogCrashHandler.h"
+#include "McLog/Utils/McLogMaintainer.h"
 
 namespace {
+struct McLoggerCacheEntry
+{
+    const char *category{nullptr};
+    QByteArray name; //!< 指针可能被复用于其他名字，命中时还需比较名字
+    IMcLoggerPtr logger; //!< 持有引用，其他线程替换repository中的logger后，本线程正在使用的logger不会被析构
+};
+
+//! 每个线程独立一份，查找时无需加锁。generation改变时整体失效
+struct McLoggerCache
+{
+    quint64 generation{0};
+    std::array<McLoggerCacheEntry, 64> entries;
+};
+
 void customMessageHandlerNone(QtMsgType msgType,
                               const QMessageLogContext &msgLogCtx,
                               const QString &msg) noexcept
@@ -40,6 +61,9 @@ void customMessageHandlerNone(QtMsgType msgType,
 MC_DECL_PRIVATE_DATA(McLogManager)
 IMcLoggerRepositoryPtr loggerRepository;
 bool handlerWhenQuit{false};
+QAtomicInteger<quint64> cacheGeneration{1};
+std::atomic<QLoggingCategory::CategoryFilter> previousFilter{nullptr};
+std::atomic_bool isFilterInstalled{false};
 MC_DECL_PRIVATE_DATA_END
 
 MC_INIT(McLogManager)
@@ -52,6 +76,10 @@ if (McLogManager::instance()->d->handlerWhenQuit) {
     qInstallMessageHandler(customMessageHandlerNone);
 }
 McLogManager::instance()->setLoggerRepository(IMcLoggerRepositoryPtr());
+//! 等待后台的文件备份等任务完成，跳过尚未开始的压缩。
+//! 超时未移动到备份目录的.rolling文件会在下次启动时由McRollingFileAppender处理
+McLogMaintainer::shutdown(3000);
+McLogCrashHandler::uninstall();
 MC_INIT_END
 
 McLogManager::McLogManager() 
@@ -71,6 +99,7 @@ IMcLoggerRepositoryPtr McLogManager::loggerRepository() const noexcept
 void McLogManager::setLoggerRepository(IMcLoggerRepositoryConstPtrRef val) noexcept 
 {
     d->loggerRepository = val;
+    invalidateLoggerCache();
 }
 
 McLogManager *McLogManager::instance() noexcept 
@@ -82,10 +111,12 @@ McLogManager *McLogManager::instance() noexcept
 void McLogManager::installQtMessageHandler() noexcept 
 {
     qInstallMessageHandler(customMessageHandler);
+    installCategoryFilter();
 }
 
 void McLogManager::uninstallQtMessageHandler() noexcept 
 {
+    uninstallCategoryFilter();
     qInstallMessageHandler(nullptr);
 }
 
@@ -99,20 +130,105 @@ void McLogManager::handlerWhenQuit(bool val) noexcept
     instance()->d->handlerWhenQuit = val;
 }
 
+void McLogManager::invalidateLoggerCache() noexcept
+{
+    instance()->d->cacheGeneration.fetchAndAddRelease(1);
+    if (instance()->d->isFilterInstalled) {
+        //! 重新安装会对所有已注册的category再执行一次过滤
+        QLoggingCategory::installFilter(categoryFilter);
+    }
+}
+
 void McLogManager::customMessageHandler(QtMsgType msgType, const QMessageLogContext &msgLogCtx, const QString &msg) noexcept 
 {
     McLogManager::instance()->output(msgType, msgLogCtx, msg);
 }
 
+void McLogManager::categoryFilter(QLoggingCategory *category) noexcept
+{
+    auto d = instance()->d.data();
+    auto previous = d->previousFilter.load();
+    if (previous != nullptr) {
+        previous(category); //!< 原有过滤器会重新设置所有类型，配置重载后被关闭的类型也能恢复
+    }
+    auto rep = instance()->loggerRepository();
+    if (rep.isNull()) {
+        return;
+    }
+    auto logger = rep->getLogger(QString::fromUtf8(category->categoryName()));
+    if (logger.isNull()) {
+        return;
+    }
+    auto types = logger->types();
+    //! QtFatalMsg无法被关闭
+    for (auto type : {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg}) {
+        if (!types.contains(type)) {
+            category->setEnabled(type, false);
+        }
+    }
+}
+
+void McLogManager::installCategoryFilter() noexcept
+{
+    auto d = instance()->d.data();
+    if (d->isFilterInstalled.exchange(true)) {
+        return;
+    }
+    auto previous = QLoggingCategory::installFilter(categoryFilter);
+    if (previous == categoryFilter) {
+        return;
+    }
+    //! 首次安装时还不知道原有过滤器，获取后再安装一次使其规则生效
+    d->previousFilter = previous;
+    QLoggingCategory::installFilter(categoryFilter);
+}
+
+void McLogManager::uninstallCategoryFilter() noexcept
+{
+    auto d = instance()->d.data();
+    if (!d->isFilterInstalled.exchange(false)) {
+        return;
+    }
+    QLoggingCategory::installFilter(d->previousFilter.exchange(nullptr));
+}
+
 void McLogManager::output(QtMsgType msgType, const QMessageLogContext &msgLogCtx, const QString &msg) noexcept 
 {
     auto rep = loggerRepository();
     if(rep.isNull()) {
         return;
     }
-    auto logger = rep->getLogger(msgLogCtx.category);
-    if(logger.isNull()) {
+    auto logger = findLogger(rep, msgLogCtx.category);
+    if (logger.isNull()) {
         return;
     }
     logger->log(msgType, msgLogCtx, msg);
+    if (msgType == QtFatalMsg) {
+        //! 返回后Qt会直接abort，事件队列中的记录没有机会再写出
+        McLogCrashHandler::flushAll();
+    }
+}
+
+IMcLoggerPtr McLogManager::findLogger(IMcLoggerRepositoryConstPtrRef rep, const char *category) noexcept
+{
+    if (category == nullptr) {
+        return rep->getLogger(category);
+    }
+    thread_local McLoggerCache cache;
+    auto generation = d->cacheGeneration.loadAcquire();
+    if (cache.generation != generation) {
+        cache.entries.fill(McLoggerCacheEntry());
+        cache.generation = generation;
+    }
+    //! category通常为字符串常量或QLoggingCategory持有的名字，按指针直接映射
+    auto &entry = cache.entries[(reinterpret_cast<quintptr>(category) >> 3) % cache.entries.size()];
+    if (entry.category == category && !entry.logger.isNull()
+        && qstrcmp(entry.name.constData(), category) == 0) {
+        return entry.logger;
+    }
+    auto logger = rep->getLogger(category);
+    entry.category = category;
+    entry.name = category;
+    entry.logger = logger;
+    return logger;
 }
@@ -24,16 +24,20 @@
 #include "McLog/Repository/impl/McLoggerRepository.h"
 
 #include <QAbstractEventDispatcher>
+#include <QReadWriteLock>
 #include <QThread>
 #include <QTimer>
 #include <QtConcurrent>
 
 #include "McLog/Appender/impl/McConsoleAppender.h"
 #include "McLog/Logger/impl/McLogger.h"
+#include "McLog/McLogManager.h"
 #include "McLog/Repository/IMcAdditionalTask.h"
+#include "McLog/Utils/McLogCrashHandler.h"
 
 MC_DECL_PRIVATE_DATA(McLoggerRepository)
 QMap<QString, IMcLoggerPtr> loggers;
+QReadWriteLock loggersLock; //!< getLogger在各个打印日志的线程中调用，可能与addLogger/setLogger同时发生
 IMcLoggerPtr notCapturedLogger;
 QThread *thread{nullptr};
 int taskTimeout{3600000};
@@ -43,6 +47,8 @@ QTimer taskTimer;
 bool flushWhenQuit{false};
 bool waitThreadFinished{true};
 qint64 threadWaitTimeout{-1};
+bool crashHandler{false};  //!< 是否在qFatal和崩溃时同步写出尚未写出的记录
+int emergencyRecords{256}; //!< 每个appender的应急缓冲区保存的最近记录条数
 MC_DECL_PRIVATE_DATA_END
 
 MC_INIT(McLoggerRepository)
@@ -95,25 +101,36 @@ McLoggerRepository::~McLoggerRepository()
 
 QMap<QString, IMcLoggerPtr> McLoggerRepository::loggers() const noexcept
 {
+    QReadLocker locker(&d->loggersLock);
     return d->loggers;
 }
 
 void McLoggerRepository::addLogger(const QString &loggerName, IMcLoggerConstPtrRef logger) noexcept
 {
-    d->loggers.insert(loggerName, logger);
+    {
+        QWriteLocker locker(&d->loggersLock);
+        d->loggers.insert(loggerName, logger);
+    }
+    McLogManager::invalidateLoggerCache();
 }
 
 void McLoggerRepository::setLogger(const QMap<QString, IMcLoggerPtr> &loggers) noexcept
 {
-    d->loggers = loggers;
+    {
+        QWriteLocker locker(&d->loggersLock);
+        d->loggers = loggers;
+    }
+    McLogManager::invalidateLoggerCache();
 }
 
 IMcLoggerPtr McLoggerRepository::getLogger(const QString &loggerName) noexcept
 {
-    if(!d->loggers.contains(loggerName)) {
+    QReadLocker locker(&d->loggersLock);
+    auto itr = d->loggers.constFind(loggerName);
+    if (itr == d->loggers.constEnd()) {
         return d->notCapturedLogger;
     }
-    return d->loggers.value(loggerName);
+    return itr.value();
 }
 
 void McLoggerRepository::runTask() noexcept
@@ -130,7 +147,7 @@ void McLoggerRepository::flushWhenQuit() noexcept
     if (!d->flushWhenQuit) {
         return;
     }
-    auto categories = d->loggers.keys();
+    auto categories = loggers().keys();
     for (const auto &category : qAsConst(categories)) {
         qDebug(QLoggingCategory(category.toLocal8Bit()));
         qInfo(QLoggingCategory(category.toLocal8Bit()));
@@ -164,6 +181,10 @@ void McLoggerRepository::allFinished() noexcept
         logger->finished();
         d->notCapturedLogger = logger;
     }
+    McLogManager::invalidateLoggerCache();
+    if (d->crashHandler) {
+        McLogCrashHandler::install(d->emergencyRecords);
+    }
     QTimer::singleShot(std::chrono::milliseconds(1000), this, &McLoggerRepository::executeTasks);
 }
 
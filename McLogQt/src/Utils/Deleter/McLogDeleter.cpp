@@ -23,12 +23,13 @@
  */
 #include "McLog/Utils/Deleter/McLogDeleter.h"
 
-#include <QRegularExpression>
 #include <QDateTime>
-#include <QTimer>
 #include <QDir>
+#include <QFileInfo>
 
 #include "McLog/McLogGlobal.h"
+#include "McLog/Utils/McLogMaintainer.h"
+#include "McLog/Utils/McLogTimeIndex.h"
 
 MC_STATIC()
 MC_REGISTER_BEAN_FACTORY(McLogDeleter)
@@ -40,6 +41,8 @@ int maxDepth{1};
 QString age{"14D"};
 int ageNumeric{14};
 QList<QString> filters;
+int sliceSize{256}; //!< 每次最多处理的文件数，处理完一批后重新排队，避免长时间占用后台线程
+McLogFileIndexPtr index;
 MC_DECL_PRIVATE_DATA_END
 
 McLogDeleter::McLogDeleter(QObject *parent) noexcept
@@ -54,6 +57,7 @@ McLogDeleter::~McLogDeleter()
 
 void McLogDeleter::finished() noexcept
 {
+    d->index = McLogFileIndexPtr::create(d->basePaths, d->maxDepth, d->filters);
     if(!d->age.endsWith("D", Qt::CaseInsensitive)) {
         MC_PRINT_ERR("age must endsWith 'D' for McLogDeleter property\n");
         return;
@@ -69,56 +73,46 @@ void McLogDeleter::finished() noexcept
 
 void McLogDeleter::execute() noexcept
 {
-    for (auto &basePath : qAsConst(d->basePaths)) {
-        auto path = Mc::toAbsolutePath(basePath);
-        checkFiles(0, path);
+    if (d->index.isNull()) {
+        return;
     }
+    //! 最后修改日期距今超过ageNumeric天的文件过期
+    auto cutoff = QDate::currentDate().addDays(-d->ageNumeric).startOfDay().toMSecsSinceEpoch();
+    auto index = d->index;
+    auto sliceSize = qMax(1, d->sliceSize);
+    McLogMaintainer::post([index, cutoff, sliceSize]() { deleteFiles(index, cutoff, sliceSize); });
 }
 
-void McLogDeleter::checkFiles(int depth, const QString &path) noexcept
+void McLogDeleter::deleteFiles(McLogFileIndexConstPtrRef index, qint64 cutoff, int sliceSize) noexcept
 {
-    auto curDepth = depth + 1;
-    if(curDepth > d->maxDepth) {
-        return;
+    if (McLogMaintainer::isShuttingDown()) {
+        return; //!< 下次启动后再处理
     }
-    QDir dir(path);
-    auto fileInfos = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-    for(auto &fileInfo : qAsConst(fileInfos)) {
-        auto absPath = fileInfo.absoluteFilePath();
-        if(fileInfo.isDir()) {
-            checkFiles(curDepth, absPath);
-            continue;
-        }
-        if(!fileNameCheck(fileInfo.fileName())) {
+    index->ensureScanned();
+    auto entries = index->takeExpired(cutoff, sliceSize);
+    for (auto &entry : entries) {
+        if (!index->recheckExpired(entry, cutoff)) {
             continue;
         }
-        auto fileDate = fileInfo.lastModified().date();
-        auto curDate = QDate::currentDate();
-        auto day = fileDate.daysTo(curDate);
-        if(day > d->ageNumeric) {
-            qInfo() << "The file has expired. deleted:" << absPath;
-            QFile::remove(absPath);
+        qInfo() << "The file has expired. deleted:" << entry.filePath;
+        QFile::remove(entry.filePath);
+        QFile::remove(McLogTimeIndex::indexPath(entry.filePath)); //!< 同时删除时间索引
+        McLogFileIndex::fileRemoved(entry.filePath);
+        //! 与原来的rmpath一致，逐级删除变空的目录，包括基础目录本身
+        auto dirPath = QFileInfo(entry.filePath).absolutePath();
+        while (dirPath == entry.basePath || dirPath.startsWith(entry.basePath + QLatin1Char('/'))) {
+            QDir dir(dirPath);
+            if (!dir.isEmpty() || !dir.rmdir(dirPath)) {
+                break;
+            }
+            dirPath = QFileInfo(dirPath).absolutePath();
         }
     }
-    fileInfos = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-    if(fileInfos.isEmpty()) {
-        dir.rmpath(path);
-    }
-}
-
-bool McLogDeleter::fileNameCheck(const QString &fileName) noexcept
-{
-    if (d->filters.isEmpty()) {
-        return true;
-    }
-    for(auto &filter : qAsConst(d->filters)) {
-        QRegularExpression reg(filter);
-        auto match = reg.match(fileName);
-        if(!match.capturedTexts().isEmpty()) {
-            return true;
-        }
+    if (entries.size() < sliceSize) {
+        return;
     }
-    return false;
+    //! 还有过期文件，重新排队处理下一批，期间其他维护任务可以执行
+    McLogMaintainer::post([index, cutoff, sliceSize]() { deleteFiles(index, cutoff, sliceSize); });
 }
 
 #include "moc_McLogDeleter.cpp"
@@ -0,0 +1,167 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Utils/McBinaryLog.h"
+
+#include <QHash>
+#include <QIODevice>
+
+MC_DECL_PRIVATE_DATA(McBinaryLogReader)
+QIODevice *device{nullptr};
+QHash<quint64, QByteArray> strings;
+qint64 lastMsecs{0};
+qint64 lastMonotonicMsecs{0};
+QString errorString;
+MC_DECL_PRIVATE_DATA_END
+
+namespace {
+
+//! 从负载中读取varint，越界时返回false
+bool takeVarint(const QByteArray &data, int &pos, quint64 &val) noexcept
+{
+    val = 0;
+    for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+        auto byte = static_cast<quint8>(data.at(pos++));
+        val |= static_cast<quint64>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+McBinaryLogReader::McBinaryLogReader(QIODevice *device) noexcept
+{
+    MC_NEW_PRIVATE_DATA(McBinaryLogReader);
+
+    d->device = device;
+}
+
+McBinaryLogReader::~McBinaryLogReader() {}
+
+bool McBinaryLogReader::readHeader() noexcept
+{
+    auto header = d->device->read(McBinaryLog::MagicSize + 1);
+    if (header.size() != McBinaryLog::MagicSize + 1
+        || !header.startsWith(QByteArray(McBinaryLog::Magic, McBinaryLog::MagicSize))) {
+        d->errorString = QStringLiteral("not a binary log file");
+        return false;
+    }
+    auto version = static_cast<quint8>(header.at(McBinaryLog::MagicSize));
+    if (version != McBinaryLog::Version) {
+        d->errorString = QStringLiteral("unsupported binary log version: %1").arg(version);
+        return false;
+    }
+    return true;
+}
+
+bool McBinaryLogReader::readNext(McLogRecord &record) noexcept
+{
+    forever {
+        quint64 size = 0;
+        if (!readVarint(size)) {
+            return false;
+        }
+        auto payload = d->device->read(static_cast<qint64>(size));
+        if (payload.size() != static_cast<int>(size) || payload.isEmpty()) {
+            d->errorString = QStringLiteral("truncated record");
+            return false;
+        }
+        int pos = 1;
+        auto kind = static_cast<quint8>(payload.at(0));
+        if (kind == McBinaryLog::String) {
+            quint64 id = 0;
+            if (!takeVarint(payload, pos, id)) {
+                d->errorString = QStringLiteral("corrupted string record");
+                return false;
+            }
+            d->strings.insert(id, payload.mid(pos));
+            continue;
+        }
+        if (kind != McBinaryLog::Log || payload.size() < 2) {
+            d->errorString = QStringLiteral("unknown record kind: %1").arg(kind);
+            return false;
+        }
+        record.type = static_cast<QtMsgType>(static_cast<quint8>(payload.at(pos++)));
+        quint64 fields[8];
+        for (auto &field : fields) {
+            if (!takeVarint(payload, pos, field)) {
+                d->errorString = QStringLiteral("corrupted log record");
+                return false;
+            }
+        }
+        auto stringOf = [this](quint64 id) -> const char * {
+            if (id == 0) {
+                return nullptr;
+            }
+            auto itr = d->strings.constFind(id);
+            return itr == d->strings.constEnd() ? "" : itr->constData();
+        };
+        record.category = stringOf(fields[0]);
+        record.file = stringOf(fields[1]);
+        record.function = stringOf(fields[2]);
+        record.line = static_cast<int>(McBinaryLog::unzigzag(fields[3]));
+        d->lastMsecs += McBinaryLog::unzigzag(fields[4]);
+        d->lastMonotonicMsecs += McBinaryLog::unzigzag(fields[5]);
+        record.msecsSinceEpoch = d->lastMsecs;
+        record.monotonicMsecs = d->lastMonotonicMsecs;
+        record.threadId = McBinaryLog::unzigzag(fields[6]);
+        record.qthreadPtr = static_cast<quintptr>(fields[7]);
+        record.message = QString::fromUtf8(payload.constData() + pos, payload.size() - pos);
+        record.isFormatted = false;
+        return true;
+    }
+}
+
+bool McBinaryLogReader::atEnd() const noexcept
+{
+    return d->device->atEnd();
+}
+
+QString McBinaryLogReader::errorString() const noexcept
+{
+    return d->errorString;
+}
+
+bool McBinaryLogReader::readVarint(quint64 &val) noexcept
+{
+    val = 0;
+    char c = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (!d->device->getChar(&c)) {
+            if (shift != 0) {
+                d->errorString = QStringLiteral("truncated record");
+            }
+            return false;
+        }
+        auto byte = static_cast<quint8>(c);
+        val |= static_cast<quint64>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    d->errorString = QStringLiteral("corrupted record length");
+    return false;
+}
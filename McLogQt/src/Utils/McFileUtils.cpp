@@ -24,7 +24,20 @@
 #include "McLog/Utils/McFileUtils.h"
 
 #include <QDateTime>
+#include <QFile>
 #include <QFileInfo>
+#include <QRegularExpression>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <qt_windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 bool McFileUtils::judgeDate(const QString &filePath, int day) noexcept
 {
@@ -32,6 +45,18 @@ bool McFileUtils::judgeDate(const QString &filePath, int day) noexcept
     if (!fileInfo.exists()) {
         return true;
     }
+    auto dateTime = birthTime(filePath);
+    if (!dateTime.isValid()) {
+        qCritical("failed get birth time of the file: %s\n", qPrintable(filePath));
+        return true;
+    }
+    auto curDateTime = QDateTime::currentDateTime();
+    return qAbs(curDateTime.daysTo(dateTime)) >= day;
+}
+
+QDateTime McFileUtils::birthTime(const QString &filePath) noexcept
+{
+    QFileInfo fileInfo(filePath);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
     auto dateTime = fileInfo.birthTime();
     if (!dateTime.isValid()) {
@@ -40,10 +65,195 @@ bool McFileUtils::judgeDate(const QString &filePath, int day) noexcept
 #else
     auto dateTime = fileInfo.created();
 #endif
-    if (!dateTime.isValid()) {
-        qCritical("failed get birth time of the file: %s\n", qPrintable(filePath));
+    return dateTime;
+}
+
+qint64 McFileUtils::dateDeadline(const QDateTime &birthTime, int day) noexcept
+{
+    if (!birthTime.isValid()) {
+        return 0;
+    }
+    return birthTime.date().addDays(day).startOfDay().toMSecsSinceEpoch();
+}
+
+bool McFileUtils::parseTimePattern(const QString &pattern,
+                                   QString &prefix,
+                                   QString &timeFormat,
+                                   QString &suffix) noexcept
+{
+    static const QRegularExpression re(R"((.*)%\{time (.*?)\}(.*))");
+    auto match = re.match(pattern);
+    if (!match.hasMatch()) {
+        prefix = pattern;
+        timeFormat.clear();
+        suffix.clear();
+        return false;
+    }
+    prefix = match.captured(1);
+    timeFormat = match.captured(2);
+    suffix = match.captured(3);
+    return true;
+}
+
+qint64 McFileUtils::utf8Size(QStringView str) noexcept
+{
+    qint64 size = 0;
+    auto src = str.utf16();
+    auto end = src + str.size();
+    while (src != end) {
+        auto u = *src++;
+        if (u < 0x80) {
+            size += 1;
+        } else if (u < 0x800) {
+            size += 2;
+        } else if (QChar::isHighSurrogate(u) && src != end && QChar::isLowSurrogate(*src)) {
+            ++src;
+            size += 4;
+        } else {
+            size += 3; //!< 孤立的代理项与appendUtf8一致，按U+FFFD计算
+        }
+    }
+    return size;
+}
+
+void McFileUtils::appendUtf8(QByteArray &out, QStringView str) noexcept
+{
+    auto base = out.size();
+    out.resize(base + str.size() * 3); //!< 每个UTF-16单元最多3字节，代理对共4字节
+    auto dst = reinterpret_cast<uchar *>(out.data()) + base;
+    auto begin = dst;
+    auto src = str.utf16();
+    auto end = src + str.size();
+    while (src != end) {
+        auto u = *src++;
+        if (u < 0x80) {
+            *dst++ = static_cast<uchar>(u);
+        } else if (u < 0x800) {
+            *dst++ = static_cast<uchar>(0xc0 | (u >> 6));
+            *dst++ = static_cast<uchar>(0x80 | (u & 0x3f));
+        } else if (QChar::isHighSurrogate(u) && src != end && QChar::isLowSurrogate(*src)) {
+            auto ucs4 = QChar::surrogateToUcs4(u, *src++);
+            *dst++ = static_cast<uchar>(0xf0 | (ucs4 >> 18));
+            *dst++ = static_cast<uchar>(0x80 | ((ucs4 >> 12) & 0x3f));
+            *dst++ = static_cast<uchar>(0x80 | ((ucs4 >> 6) & 0x3f));
+            *dst++ = static_cast<uchar>(0x80 | (ucs4 & 0x3f));
+        } else {
+            if (QChar::isSurrogate(u)) {
+                u = QChar::ReplacementCharacter;
+            }
+            *dst++ = static_cast<uchar>(0xe0 | (u >> 12));
+            *dst++ = static_cast<uchar>(0x80 | ((u >> 6) & 0x3f));
+            *dst++ = static_cast<uchar>(0x80 | (u & 0x3f));
+        }
+    }
+    out.resize(base + (dst - begin));
+}
+
+bool McFileUtils::lockFile(QFileDevice *file) noexcept
+{
+    if (file == nullptr || file->handle() == -1) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    auto handle = reinterpret_cast<HANDLE>(::_get_osfhandle(file->handle()));
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    return ::LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped) != 0;
+#else
+    int ret = 0;
+    do {
+        ret = ::flock(file->handle(), LOCK_EX);
+    } while (ret == -1 && errno == EINTR);
+    return ret == 0;
+#endif
+}
+
+bool McFileUtils::unlockFile(QFileDevice *file) noexcept
+{
+    if (file == nullptr || file->handle() == -1) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    auto handle = reinterpret_cast<HANDLE>(::_get_osfhandle(file->handle()));
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    return ::UnlockFileEx(handle, 0, MAXDWORD, MAXDWORD, &overlapped) != 0;
+#else
+    return ::flock(file->handle(), LOCK_UN) == 0;
+#endif
+}
+
+bool McFileUtils::isSameFile(QFileDevice *file, const QString &filePath) noexcept
+{
+#ifdef Q_OS_WIN
+    //! Windows下其他进程无法重命名已被打开的文件
+    Q_UNUSED(file)
+    Q_UNUSED(filePath)
+    return true;
+#else
+    if (file == nullptr || file->handle() == -1) {
+        return false;
+    }
+    struct stat fileStat;
+    struct stat pathStat;
+    if (::fstat(file->handle(), &fileStat) != 0
+        || ::stat(QFile::encodeName(filePath).constData(), &pathStat) != 0) {
+        return false;
+    }
+    return fileStat.st_dev == pathStat.st_dev && fileStat.st_ino == pathStat.st_ino;
+#endif
+}
+
+bool McFileUtils::syncFile(QFileDevice *file) noexcept
+{
+    if (file == nullptr || !file->isOpen()) {
+        return false;
+    }
+    auto fd = file->handle();
+    if (fd == -1) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return ::_commit(fd) == 0;
+#elif defined(Q_OS_DARWIN)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+bool McFileUtils::preallocate(QFileDevice *file, qint64 size) noexcept
+{
+    if (file == nullptr || !file->isOpen()) {
+        return false;
+    }
+#if defined(Q_OS_LINUX)
+    //! 真正分配磁盘块，避免写入映射内存时因磁盘空间不足而收到SIGBUS
+    auto fd = file->handle();
+    if (fd != -1 && ::posix_fallocate(fd, 0, static_cast<off_t>(size)) == 0) {
         return true;
     }
-    auto curDateTime = QDateTime::currentDateTime();
-    return qAbs(curDateTime.daysTo(dateTime)) >= day;
+#endif
+    return file->resize(size);
+}
+
+qint64 McFileUtils::sizeFromString(const QString &val) noexcept
+{
+    auto temp = val.trimmed().toUpper();
+    qint64 unit = 1;
+    if (temp.endsWith("GB")) {
+        unit = 1024 * 1024 * 1024;
+    } else if (temp.endsWith("MB")) {
+        unit = 1024 * 1024;
+    } else if (temp.endsWith("KB")) {
+        unit = 1024;
+    } else if (temp.endsWith("B")) {
+        temp.chop(1);
+    }
+    if (unit != 1) {
+        temp.chop(2);
+    }
+    bool ok = false;
+    auto size = temp.toLongLong(&ok);
+    return ok && size > 0 ? size * unit : -1;
 }
@@ -0,0 +1,469 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Utils/McLogCrashHandler.h"
+
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+#include <QDateTime>
+#include <QMutex>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include "McLog/Appender/impl/McAbstractFormatAppender.h"
+
+namespace {
+
+constexpr int kSlotSize = 1024; //!< 每条记录最多保存的字节数，超出部分截断
+constexpr int kMaxAppenders = 64;
+
+struct McEmergencySlot
+{
+    std::atomic<quint64> sequence{0}; //!< 写入完成后为序号+1，写入中为0
+    qint64 msecsSinceEpoch{0};
+    int size{0};
+    bool isFormatted{false};
+    char data[kSlotSize];
+};
+
+//! 一个appender的应急缓冲区。缓冲区分配后不再释放，appender析构后留给之后登记的appender使用
+struct McCrashTarget
+{
+    std::atomic<McAbstractFormatAppender *> appender{nullptr};
+    std::atomic<McEmergencySlot *> slots{nullptr};
+    std::atomic<int> fd{-1};
+    std::atomic_bool crlf{false};
+    std::atomic<quint64> nextSequence{0};
+    std::atomic<quint64> writtenSequence{0}; //!< 序号+1不大于此值的记录已写入文件
+};
+
+#ifdef Q_OS_WIN
+constexpr std::array<int, 4> kCrashSignals{SIGSEGV, SIGABRT, SIGFPE, SIGILL};
+using McSignalAction = void (*)(int);
+#else
+constexpr std::array<int, 5> kCrashSignals{SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL};
+using McSignalAction = struct sigaction;
+#endif
+
+//! 信号处理函数中只访问这些预先初始化的静态变量
+McCrashTarget targets[kMaxAppenders];
+int emergencySlotCount{0};
+QBasicMutex registerMutex; //!< 只保护登记和分配缓冲区，信号处理函数中不使用。常量初始化，退出时析构的appender仍可使用
+std::atomic_bool isCaptureEnabled{false};
+std::atomic_bool isHandlerInstalled{false};
+std::atomic_bool isHandling{false};
+std::array<McSignalAction, kCrashSignals.size()> previousActions;
+
+qsizetype appendText(char *out, qsizetype pos, qsizetype capacity, const char *str) noexcept
+{
+    for (; str != nullptr && *str != '\0' && pos < capacity; ++str) {
+        out[pos++] = *str;
+    }
+    return pos;
+}
+
+//! 不分配内存的UTF-16到UTF-8转换，空间不足时在字符边界截断
+qsizetype appendUtf8(char *out, qsizetype pos, qsizetype capacity, const QString &str) noexcept
+{
+    auto data = str.utf16();
+    auto size = str.size();
+    for (qsizetype i = 0; i < size; ++i) {
+        uint c = data[i];
+        if (QChar::isHighSurrogate(c) && i + 1 < size && QChar::isLowSurrogate(data[i + 1])) {
+            c = QChar::surrogateToUcs4(QChar(data[i]), QChar(data[i + 1]));
+            ++i;
+        }
+        if (c < 0x80) {
+            if (pos + 1 > capacity) {
+                break;
+            }
+            out[pos++] = static_cast<char>(c);
+        } else if (c < 0x800) {
+            if (pos + 2 > capacity) {
+                break;
+            }
+            out[pos++] = static_cast<char>(0xC0 | (c >> 6));
+            out[pos++] = static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            if (pos + 3 > capacity) {
+                break;
+            }
+            out[pos++] = static_cast<char>(0xE0 | (c >> 12));
+            out[pos++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[pos++] = static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            if (pos + 4 > capacity) {
+                break;
+            }
+            out[pos++] = static_cast<char>(0xF0 | (c >> 18));
+            out[pos++] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out[pos++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[pos++] = static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return pos;
+}
+
+const char *levelName(QtMsgType type) noexcept
+{
+    switch (type) {
+    case QtDebugMsg:
+        return "debug";
+    case QtInfoMsg:
+        return "info";
+    case QtWarningMsg:
+        return "warning";
+    case QtCriticalMsg:
+        return "critical";
+    case QtFatalMsg:
+        return "fatal";
+    }
+    return "unknown";
+}
+
+//! 按固定宽度写出十进制数字，只用于信号处理函数
+char *putDigits(char *out, qint64 value, int width) noexcept
+{
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return out + width;
+}
+
+//! 将UTC毫秒时间写为yyyy-MM-ddThh:mm:ss.zzzZ，不调用任何非异步信号安全的函数
+qsizetype formatUtcTime(char *out, qint64 msecs) noexcept
+{
+    auto days = msecs / 86400000;
+    auto rest = msecs % 86400000;
+    if (rest < 0) {
+        rest += 86400000;
+        --days;
+    }
+    //! 由天数计算公历日期
+    days += 719468;
+    auto era = (days >= 0 ? days : days - 146096) / 146097;
+    auto doe = days - era * 146097;
+    auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    auto mp = (5 * doy + 2) / 153;
+    auto day = doy - (153 * mp + 2) / 5 + 1;
+    auto month = mp < 10 ? mp + 3 : mp - 9;
+    auto year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+    auto p = out;
+    p = putDigits(p, year, 4);
+    *p++ = '-';
+    p = putDigits(p, month, 2);
+    *p++ = '-';
+    p = putDigits(p, day, 2);
+    *p++ = 'T';
+    p = putDigits(p, rest / 3600000, 2);
+    *p++ = ':';
+    p = putDigits(p, rest / 60000 % 60, 2);
+    *p++ = ':';
+    p = putDigits(p, rest / 1000 % 60, 2);
+    *p++ = '.';
+    p = putDigits(p, rest % 1000, 3);
+    *p++ = 'Z';
+    return p - out;
+}
+
+void allocateSlots(McCrashTarget &target) noexcept
+{
+    if (emergencySlotCount > 0 && target.slots.load(std::memory_order_relaxed) == nullptr) {
+        target.slots.store(new McEmergencySlot[static_cast<size_t>(emergencySlotCount)],
+                           std::memory_order_release);
+    }
+}
+
+//! 把target中尚未写出的记录写入它自己的文件
+void dumpPendingRecords(McCrashTarget &target, const char *header, qsizetype headerSize) noexcept
+{
+    auto fd = target.fd.load(std::memory_order_acquire);
+    auto slots = target.slots.load(std::memory_order_acquire);
+    if (fd == -1 || slots == nullptr || target.appender.load(std::memory_order_acquire) == nullptr) {
+        return;
+    }
+    auto end = target.nextSequence.load(std::memory_order_acquire);
+    auto begin = qMax(target.writtenSequence.load(std::memory_order_acquire),
+                      end > quint64(emergencySlotCount) ? end - quint64(emergencySlotCount) : 0);
+    if (begin >= end) {
+        return;
+    }
+    const char *separator = target.crlf.load(std::memory_order_relaxed) ? "\r\n" : "\n";
+    auto separatorSize = qsizetype(separator[1] == '\0' ? 1 : 2);
+    McLogCrashHandler::writeAll(fd, header, headerSize);
+    McLogCrashHandler::writeAll(fd, separator, separatorSize);
+    char time[32];
+    char data[kSlotSize];
+    for (auto sequence = begin; sequence < end; ++sequence) {
+        auto &slot = slots[sequence % quint64(emergencySlotCount)];
+        //! 写入中或已被更新的记录跳过
+        if (slot.sequence.load(std::memory_order_acquire) != sequence + 1) {
+            continue;
+        }
+        auto msecsSinceEpoch = slot.msecsSinceEpoch;
+        auto isFormatted = slot.isFormatted;
+        auto size = qBound(0, slot.size, kSlotSize);
+        memcpy(data, slot.data, static_cast<size_t>(size));
+        //! 拷贝期间其他线程可能开始覆盖该槽位，拷贝完成后序号未变才说明内容完整
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence + 1) {
+            continue;
+        }
+        if (!isFormatted) {
+            auto timeSize = formatUtcTime(time, msecsSinceEpoch);
+            time[timeSize++] = ' ';
+            McLogCrashHandler::writeAll(fd, time, timeSize);
+        }
+        McLogCrashHandler::writeAll(fd, data, size);
+        McLogCrashHandler::writeAll(fd, separator, separatorSize);
+    }
+}
+
+void restorePreviousAction(int index) noexcept
+{
+#ifdef Q_OS_WIN
+    ::signal(kCrashSignals[index], previousActions[index]);
+#else
+    ::sigaction(kCrashSignals[index], &previousActions[index], nullptr);
+#endif
+}
+
+void crashSignalHandler(int sig)
+{
+    if (!isHandling.exchange(true)) {
+        char header[96];
+        auto pos = appendText(header, 0, sizeof(header), "---------- McLogQt caught signal ");
+        char number[16];
+        auto end = number + sizeof(number);
+        auto begin = end;
+        auto value = sig;
+        do {
+            *--begin = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        memcpy(header + pos, begin, static_cast<size_t>(end - begin));
+        pos += end - begin;
+        pos = appendText(header, pos, sizeof(header), ", pending records ----------");
+        //! 这里只能使用异步信号安全的操作，只把预先编码好的记录write到各appender登记的文件中
+        for (auto &target : targets) {
+            dumpPendingRecords(target, header, pos);
+        }
+    }
+    //! 交还给原有的处理函数，默认行为会终止进程并产生core文件
+    for (size_t i = 0; i < kCrashSignals.size(); ++i) {
+        if (kCrashSignals[i] == sig) {
+            restorePreviousAction(static_cast<int>(i));
+        }
+    }
+    ::raise(sig);
+}
+
+} // namespace
+
+void McLogCrashHandler::install(int emergencyRecords) noexcept
+{
+    if (isHandlerInstalled.exchange(true)) {
+        return;
+    }
+    {
+        QMutexLocker locker(&registerMutex);
+        //! 缓冲区只分配一次，之后重新安装沿用第一次的大小，避免释放其他线程正在写入的内存
+        if (emergencySlotCount == 0 && emergencyRecords > 0) {
+            emergencySlotCount = emergencyRecords;
+        }
+        for (auto &target : targets) {
+            if (target.appender.load(std::memory_order_relaxed) != nullptr) {
+                allocateSlots(target);
+            }
+        }
+    }
+    isCaptureEnabled.store(emergencySlotCount > 0, std::memory_order_release);
+
+#ifdef Q_OS_WIN
+    for (size_t i = 0; i < kCrashSignals.size(); ++i) {
+        previousActions[i] = ::signal(kCrashSignals[i], crashSignalHandler);
+    }
+#else
+    //! 栈溢出时原有的栈已不可用，为安装线程准备备用栈
+    static const bool isAltStackReady = []() {
+        stack_t stack{};
+        stack.ss_size = 64 * 1024;
+        stack.ss_sp = std::malloc(stack.ss_size);
+        return stack.ss_sp != nullptr && ::sigaltstack(&stack, nullptr) == 0;
+    }();
+    struct sigaction action
+    {};
+    action.sa_handler = crashSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = isAltStackReady ? SA_ONSTACK : 0;
+    for (size_t i = 0; i < kCrashSignals.size(); ++i) {
+        ::sigaction(kCrashSignals[i], &action, &previousActions[i]);
+    }
+#endif
+}
+
+void McLogCrashHandler::uninstall() noexcept
+{
+    if (!isHandlerInstalled.exchange(false)) {
+        return;
+    }
+    isCaptureEnabled.store(false, std::memory_order_release);
+    for (size_t i = 0; i < kCrashSignals.size(); ++i) {
+        restorePreviousAction(static_cast<int>(i));
+    }
+}
+
+bool McLogCrashHandler::isInstalled() noexcept
+{
+    return isHandlerInstalled.load();
+}
+
+int McLogCrashHandler::addAppender(McAbstractFormatAppender *appender) noexcept
+{
+    QMutexLocker locker(&registerMutex);
+    for (int i = 0; i < kMaxAppenders; ++i) {
+        auto &target = targets[i];
+        if (target.appender.load(std::memory_order_relaxed) != nullptr) {
+            continue;
+        }
+        //! 上一个使用者留下的记录不属于新的appender
+        target.writtenSequence.store(target.nextSequence.load(std::memory_order_relaxed),
+                                     std::memory_order_relaxed);
+        target.fd.store(-1, std::memory_order_relaxed);
+        if (isHandlerInstalled.load()) {
+            allocateSlots(target);
+        }
+        target.appender.store(appender, std::memory_order_release);
+        return i;
+    }
+    MC_PRINT_ERR("too many appenders for crash handler, max: %d\n", kMaxAppenders);
+    return -1;
+}
+
+void McLogCrashHandler::removeAppender(int target) noexcept
+{
+    if (target < 0 || target >= kMaxAppenders) {
+        return;
+    }
+    QMutexLocker locker(&registerMutex);
+    targets[target].fd.store(-1, std::memory_order_release);
+    targets[target].appender.store(nullptr, std::memory_order_release);
+}
+
+void McLogCrashHandler::setAppenderFd(int target, int fd, bool crlf) noexcept
+{
+    if (target < 0 || target >= kMaxAppenders) {
+        return;
+    }
+    targets[target].crlf.store(crlf, std::memory_order_relaxed);
+    targets[target].fd.store(fd, std::memory_order_release);
+}
+
+quint64 McLogCrashHandler::capture(int target,
+                                   QtMsgType type,
+                                   const QMessageLogContext &context,
+                                   const QString &str,
+                                   bool isFormatted) noexcept
+{
+    if (target < 0 || !isCaptureEnabled.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    auto &crashTarget = targets[target];
+    auto slots = crashTarget.slots.load(std::memory_order_acquire);
+    if (slots == nullptr) {
+        return 0;
+    }
+    auto sequence = crashTarget.nextSequence.fetch_add(1, std::memory_order_relaxed);
+    auto &slot = slots[sequence % quint64(emergencySlotCount)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    qsizetype pos = 0;
+    if (!isFormatted) {
+        slot.msecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+        pos = appendText(slot.data, pos, kSlotSize, "[");
+        pos = appendText(slot.data, pos, kSlotSize, context.category);
+        pos = appendText(slot.data, pos, kSlotSize, "][");
+        pos = appendText(slot.data, pos, kSlotSize, levelName(type));
+        pos = appendText(slot.data, pos, kSlotSize, "]: ");
+    }
+    pos = appendUtf8(slot.data, pos, kSlotSize, str);
+    slot.isFormatted = isFormatted;
+    slot.size = static_cast<int>(pos);
+    slot.sequence.store(sequence + 1, std::memory_order_release);
+    return sequence + 1;
+}
+
+void McLogCrashHandler::markWritten(int target, quint64 sequence) noexcept
+{
+    if (target < 0 || sequence == 0) {
+        return;
+    }
+    //! 只有写出线程调用，但qFatal时调用线程也可能调用，取较大值
+    auto &written = targets[target].writtenSequence;
+    auto current = written.load(std::memory_order_relaxed);
+    while (sequence > current
+           && !written.compare_exchange_weak(current, sequence, std::memory_order_release)) {
+    }
+}
+
+void McLogCrashHandler::flushAll() noexcept
+{
+    for (auto &target : targets) {
+        auto a = target.appender.load(std::memory_order_acquire);
+        if (a != nullptr) {
+            a->emergencyFlush();
+        }
+    }
+}
+
+bool McLogCrashHandler::writeAll(int fd, const char *data, qsizetype size) noexcept
+{
+    while (size > 0) {
+#ifdef Q_OS_WIN
+        auto ret = ::_write(fd, data, static_cast<unsigned int>(size));
+#else
+        auto ret = ::write(fd, data, static_cast<size_t>(size));
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (ret <= 0) {
+            return false;
+        }
+        data += ret;
+        size -= ret;
+    }
+    return true;
+}
@@ -0,0 +1,227 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Utils/McLogFileIndex.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+namespace {
+
+constexpr qint64 kRescanInterval = 24 * 60 * 60 * 1000;
+
+} // namespace
+
+MC_GLOBAL_STATIC_BEGIN(indexRegistry)
+QMutex mutex;
+QList<McLogFileIndex *> indexes;
+MC_GLOBAL_STATIC_END(indexRegistry)
+
+McLogFileIndex::McLogFileIndex(const QStringList &basePaths, int maxDepth, const QStringList &filters) noexcept
+    : m_maxDepth(maxDepth)
+{
+    for (auto &basePath : basePaths) {
+        m_basePaths.append(QDir::cleanPath(Mc::toAbsolutePath(basePath)));
+    }
+    for (auto &filter : filters) {
+        m_filters.append(QRegularExpression(filter));
+    }
+    QMutexLocker locker(&indexRegistry->mutex);
+    indexRegistry->indexes.append(this);
+}
+
+McLogFileIndex::~McLogFileIndex()
+{
+    if (indexRegistry.isDestroyed()) {
+        return;
+    }
+    QMutexLocker locker(&indexRegistry->mutex);
+    indexRegistry->indexes.removeOne(this);
+}
+
+void McLogFileIndex::ensureScanned() noexcept
+{
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_lastScanTime != 0 && now - m_lastScanTime < kRescanInterval) {
+            return;
+        }
+        m_lastScanTime = now;
+    }
+    rescan();
+}
+
+QList<McLogFileIndex::Entry> McLogFileIndex::takeExpired(qint64 cutoff, int count) noexcept
+{
+    QList<Entry> entries;
+    QMutexLocker locker(&m_mutex);
+    auto itr = m_entries.begin();
+    while (itr != m_entries.end() && itr.key() < cutoff && entries.size() < count) {
+        m_lastModified.remove(itr->filePath);
+        entries.append(*itr);
+        itr = m_entries.erase(itr);
+    }
+    return entries;
+}
+
+bool McLogFileIndex::recheckExpired(Entry &entry, qint64 cutoff) noexcept
+{
+    QFileInfo fileInfo(entry.filePath);
+    if (!fileInfo.exists()) {
+        return false;
+    }
+    entry.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    if (entry.lastModified >= cutoff) {
+        insert(entry.filePath, entry.basePath, entry.lastModified);
+        return false;
+    }
+    return true;
+}
+
+void McLogFileIndex::fileAdded(const QString &filePath) noexcept
+{
+    QFileInfo fileInfo(filePath);
+    auto absPath = QDir::cleanPath(fileInfo.absoluteFilePath());
+    auto lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    QMutexLocker locker(&indexRegistry->mutex);
+    for (auto index : qAsConst(indexRegistry->indexes)) {
+        QString basePath;
+        if (!index->accept(absPath, basePath)) {
+            continue;
+        }
+        index->insert(absPath, basePath, lastModified);
+    }
+}
+
+void McLogFileIndex::fileRemoved(const QString &filePath) noexcept
+{
+    auto absPath = QDir::cleanPath(QFileInfo(filePath).absoluteFilePath());
+    QMutexLocker locker(&indexRegistry->mutex);
+    for (auto index : qAsConst(indexRegistry->indexes)) {
+        index->remove(absPath);
+    }
+}
+
+void McLogFileIndex::rescan() noexcept
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_entries.clear();
+        m_lastModified.clear();
+    }
+    for (auto &basePath : qAsConst(m_basePaths)) {
+        scanDir(0, basePath, basePath);
+    }
+}
+
+void McLogFileIndex::scanDir(int depth, const QString &basePath, const QString &path) noexcept
+{
+    auto curDepth = depth + 1;
+    if (curDepth > m_maxDepth) {
+        return;
+    }
+    QDir dir(path);
+    auto fileInfos = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    for (auto &fileInfo : qAsConst(fileInfos)) {
+        auto absPath = fileInfo.absoluteFilePath();
+        if (fileInfo.isDir()) {
+            scanDir(curDepth, basePath, absPath);
+            continue;
+        }
+        if (!fileNameCheck(fileInfo.fileName())) {
+            continue;
+        }
+        insert(QDir::cleanPath(absPath), basePath, fileInfo.lastModified().toMSecsSinceEpoch());
+    }
+}
+
+bool McLogFileIndex::accept(const QString &filePath, QString &basePath) const noexcept
+{
+    if (!fileNameCheck(QFileInfo(filePath).fileName())) {
+        return false;
+    }
+    for (auto &path : m_basePaths) {
+        if (!filePath.startsWith(path + QLatin1Char('/'))) {
+            continue;
+        }
+        //! 与扫描时一致，基础目录下的文件深度为1
+        auto depth = filePath.mid(path.size() + 1).count(QLatin1Char('/')) + 1;
+        if (depth > m_maxDepth) {
+            continue;
+        }
+        basePath = path;
+        return true;
+    }
+    return false;
+}
+
+bool McLogFileIndex::fileNameCheck(const QString &fileName) const noexcept
+{
+    if (m_filters.isEmpty()) {
+        return true;
+    }
+    for (auto &filter : m_filters) {
+        if (filter.match(fileName).hasMatch()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void McLogFileIndex::insert(const QString &filePath, const QString &basePath, qint64 lastModified) noexcept
+{
+    QMutexLocker locker(&m_mutex);
+    auto itr = m_lastModified.constFind(filePath);
+    if (itr != m_lastModified.constEnd()) {
+        auto old = m_entries.find(itr.value());
+        while (old != m_entries.end() && old.key() == itr.value()) {
+            if (old->filePath == filePath) {
+                m_entries.erase(old);
+                break;
+            }
+            ++old;
+        }
+    }
+    m_entries.insert(lastModified, Entry{filePath, basePath, lastModified});
+    m_lastModified.insert(filePath, lastModified);
+}
+
+void McLogFileIndex::remove(const QString &filePath) noexcept
+{
+    QMutexLocker locker(&m_mutex);
+    auto itr = m_lastModified.find(filePath);
+    if (itr == m_lastModified.end()) {
+        return;
+    }
+    auto entry = m_entries.find(itr.value());
+    while (entry != m_entries.end() && entry.key() == itr.value()) {
+        if (entry->filePath == filePath) {
+            m_entries.erase(entry);
+            break;
+        }
+        ++entry;
+    }
+    m_lastModified.erase(itr);
+}
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Utils/McLogMaintainer.h"
+
+#include <atomic>
+
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+
+std::atomic_bool isShutdown{false};
+
+QThreadPool &maintainerPool() noexcept
+{
+    static QThreadPool pool;
+    //! 只使用一个线程，保证同一文件的重命名、压缩等任务按顺序执行
+    static bool isInit = []() {
+        pool.setMaxThreadCount(1);
+        pool.setExpiryTimeout(-1);
+        return true;
+    }();
+    Q_UNUSED(isInit)
+    return pool;
+}
+
+} // namespace
+
+void McLogMaintainer::post(const std::function<void()> &task) noexcept
+{
+    maintainerPool().start([task]() {
+        QThread::currentThread()->setPriority(QThread::LowestPriority);
+        task();
+    });
+}
+
+bool McLogMaintainer::waitForDone(int msecs) noexcept
+{
+    return maintainerPool().waitForDone(msecs);
+}
+
+bool McLogMaintainer::shutdown(int msecs) noexcept
+{
+    isShutdown = true;
+    return maintainerPool().waitForDone(msecs);
+}
+
+bool McLogMaintainer::isShuttingDown() noexcept
+{
+    return isShutdown;
+}
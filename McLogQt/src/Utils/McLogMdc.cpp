@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Utils/McLogMdc.h"
+
+namespace {
+
+//! 键值对通常很少，使用有序列表保持放入顺序
+McLogMdc::Entries &threadEntries() noexcept
+{
+    thread_local McLogMdc::Entries entries;
+    return entries;
+}
+
+} // namespace
+
+void McLogMdc::put(const QString &key, const QString &value) noexcept
+{
+    auto &entries = threadEntries();
+    for (auto &entry : entries) {
+        if (entry.first == key) {
+            entry.second = value;
+            return;
+        }
+    }
+    entries.append(qMakePair(key, value));
+}
+
+void McLogMdc::remove(const QString &key) noexcept
+{
+    auto &entries = threadEntries();
+    for (int i = 0; i < entries.size(); ++i) {
+        if (entries.at(i).first == key) {
+            entries.removeAt(i);
+            return;
+        }
+    }
+}
+
+void McLogMdc::clear() noexcept
+{
+    threadEntries().clear();
+}
+
+McLogMdc::Entries McLogMdc::entries() noexcept
+{
+    return threadEntries(); //!< 隐式共享，只增加引用计数
+}
+
+McLogMdcScope::McLogMdcScope(const QString &key, const QString &value) noexcept
+    : m_key(key)
+{
+    McLogMdc::put(key, value);
+}
+
+McLogMdcScope::~McLogMdcScope()
+{
+    McLogMdc::remove(m_key);
+}
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Utils/McLogRecord.h"
+
+#include <cstring>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "McLog/Utils/McMessagePattern.h"
+
+McLogRecord McLogRecord::capture(QtMsgType type,
+                                 const QMessageLogContext &context,
+                                 const QString &str) noexcept
+{
+    McLogRecord record;
+    record.type = type;
+    record.line = context.line;
+    //! 三个字符串拷贝到同一块内存中，每条记录只分配一次
+    const char *sources[] = {context.category, context.file, context.function};
+    const char **targets[] = {&record.category, &record.file, &record.function};
+    int lengths[3];
+    int total = 0;
+    for (int i = 0; i < 3; ++i) {
+        lengths[i] = sources[i] == nullptr ? -1 : static_cast<int>(qstrlen(sources[i]));
+        total += lengths[i] + 1;
+    }
+    if (total > 0) {
+        record.contextStrings.resize(total);
+        auto data = record.contextStrings.data();
+        for (int i = 0; i < 3; ++i) {
+            if (lengths[i] < 0) {
+                continue;
+            }
+            memcpy(data, sources[i], lengths[i] + 1);
+            *targets[i] = data;
+            data += lengths[i] + 1;
+        }
+    }
+    record.msecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+    QElapsedTimer now;
+    now.start();
+    record.monotonicMsecs = now.msecsSinceReference();
+    record.threadId = McPrivate::currentThreadId();
+    record.qthreadPtr = reinterpret_cast<quintptr>(QThread::currentThread());
+    record.message = str;
+    record.mdc = McLogMdc::entries();
+    record.backtrace = McPrivate::captureBacktrace();
+    return record;
+}
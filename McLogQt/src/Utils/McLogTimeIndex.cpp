@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McLog/Utils/McLogTimeIndex.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#ifndef MC_DISABLE_QUAZIP
+#include <McIoc/Utils/Zip/McCompressor.h>
+#endif
+
+namespace McLogTimeIndex {
+
+QString indexPath(const QString &logPath) noexcept
+{
+    auto path = logPath;
+    if (path.endsWith(QLatin1String(".gz"))) {
+        path.chop(3);
+    }
+    return path + QStringLiteral(".idx");
+}
+
+QByteArray header(qint64 interval) noexcept
+{
+    QByteArray out(Magic, MagicSize);
+    out.append(static_cast<char>(Version));
+    out.append('\0');
+    char buf[8];
+    qToLittleEndian<qint64>(interval, buf);
+    out.append(buf, sizeof(buf));
+    return out;
+}
+
+void appendEntry(QByteArray &out, const Entry &entry) noexcept
+{
+    char buf[EntrySize];
+    qToLittleEndian<qint64>(entry.msecsSinceEpoch, buf);
+    qToLittleEndian<qint64>(entry.offset, buf + 8);
+    out.append(buf, sizeof(buf));
+}
+
+bool read(const QString &indexPath, qint64 &interval, QVector<Entry> &entries) noexcept
+{
+    QFile file(indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    auto data = file.readAll();
+    if (data.size() < HeaderSize || !data.startsWith(QByteArray(Magic, MagicSize))
+        || static_cast<quint8>(data.at(MagicSize)) != Version) {
+        return false;
+    }
+    interval = qFromLittleEndian<qint64>(data.constData() + 8);
+    entries.clear();
+    entries.reserve((data.size() - HeaderSize) / EntrySize);
+    for (auto pos = HeaderSize; pos + EntrySize <= data.size(); pos += EntrySize) {
+        Entry entry;
+        entry.msecsSinceEpoch = qFromLittleEndian<qint64>(data.constData() + pos);
+        entry.offset = qFromLittleEndian<qint64>(data.constData() + pos + 8);
+        entries.append(entry);
+    }
+    return true;
+}
+
+bool copyRange(const QString &logPath, qint64 from, qint64 to, QIODevice *out) noexcept
+{
+    qint64 interval = 0;
+    QVector<Entry> entries;
+    if (out == nullptr || !read(indexPath(logPath), interval, entries)) {
+        return false;
+    }
+    if (entries.isEmpty() || entries.first().msecsSinceEpoch > to
+        || entries.last().msecsSinceEpoch + interval <= from) {
+        return true; //!< 整个文件都不在范围内
+    }
+    //! 起点为最后一个不晚于from的时间桶，终点为第一个晚于to的时间桶
+    qint64 begin = 0;
+    qint64 end = -1;
+    for (auto &entry : qAsConst(entries)) {
+        if (entry.msecsSinceEpoch <= from) {
+            begin = entry.offset;
+        } else if (entry.msecsSinceEpoch > to) {
+            end = entry.offset;
+            break;
+        }
+    }
+    auto size = end == -1 ? qint64(-1) : end - begin;
+    if (size == 0) {
+        return true;
+    }
+    if (logPath.endsWith(QLatin1String(".gz"))) {
+#ifndef MC_DISABLE_QUAZIP
+        return McCompressor::gunzipRange(logPath, begin, size, out);
+#else
+        MC_PRINT_ERR("cannot read compressed log without zlib: %s\n", qPrintable(logPath));
+        return false;
+#endif
+    }
+    QFile file(logPath);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(begin)) {
+        return false;
+    }
+    QByteArray buf(64 * 1024, Qt::Uninitialized);
+    auto remaining = size;
+    while (remaining != 0) {
+        auto len = remaining < 0 ? buf.size() : qMin<qint64>(buf.size(), remaining);
+        auto readLen = file.read(buf.data(), len);
+        if (readLen <= 0) {
+            break; //!< 索引可能比日志先落盘，以文件的实际长度为准
+        }
+        if (out->write(buf.constData(), readLen) != readLen) {
+            return false;
+        }
+        if (remaining > 0) {
+            remaining -= readLen;
+        }
+    }
+    return true;
+}
+
+} // namespace McLogTimeIndex
@@ -22,29 +22,52 @@
  * SOFTWARE.
  */
 #include "McLog/Utils/McMessagePattern.h"
+#include "McLog/Utils/McFileUtils.h"
+#include "McLog/Utils/McLogRecord.h"
 
 #include <QCoreApplication>
 #include <QDateTime>
+#include <QHash>
 #include <QThread>
+#include <QVarLengthArray>
 
-namespace McPrivate {
-
-static bool isDefaultCategory(const char *category) 
-{
-    return !category || strcmp(category, "default") == 0;
-}
+#include <limits>
+#include <type_traits>
 
 #ifndef QT_HAS_INCLUDE
 #  define QT_HAS_INCLUDE(x) 0
 #endif
 
+// system headers must be included at file scope, not inside namespace McPrivate
 #ifndef QT_BOOTSTRAPPED
 #if defined(Q_OS_LINUX) && (defined(__GLIBC__) || QT_HAS_INCLUDE(<sys/syscall.h>))
 #  include <sys/syscall.h>
 #if  QT_HAS_INCLUDE(<unistd.h>)
 #   include <unistd.h>
 #endif
+#elif defined(Q_OS_DARWIN)
+#  include <pthread.h>
+#elif defined(Q_OS_FREEBSD_KERNEL) && defined(__FreeBSD_version) && __FreeBSD_version >= 900031
+#  include <pthread_np.h>
+#endif
 
+#ifdef QLOGGING_HAVE_BACKTRACE
+#  include <qmutex.h>
+#  include <qregularexpression.h>
+#  include <cxxabi.h>
+#  include <execinfo.h>
+#endif
+#endif // !QT_BOOTSTRAPPED
+
+namespace McPrivate {
+
+static bool isDefaultCategory(const char *category) 
+{
+    return !category || strcmp(category, "default") == 0;
+}
+
+#ifndef QT_BOOTSTRAPPED
+#if defined(Q_OS_LINUX) && (defined(__GLIBC__) || QT_HAS_INCLUDE(<sys/syscall.h>))
 # if defined(Q_OS_ANDROID) && !defined(SYS_gettid)
 #  define SYS_gettid __NR_gettid
 # endif
@@ -56,7 +79,6 @@ static long mc_gettid()
     return syscall(SYS_gettid);
 }
 #elif defined(Q_OS_DARWIN)
-#  include <pthread.h>
 static int mc_gettid() 
 {
     // no error handling: this call cannot fail
@@ -65,7 +87,6 @@ static int mc_gettid()
     return tid;
 }
 #elif defined(Q_OS_FREEBSD_KERNEL) && defined(__FreeBSD_version) && __FreeBSD_version >= 900031
-#  include <pthread_np.h>
 static int mc_gettid() 
 {
     return pthread_getthreadid_np();
@@ -77,12 +98,6 @@ static QT_PREPEND_NAMESPACE(qint64) mc_gettid()
     return qintptr(QThread::currentThreadId());
 }
 #endif
-
-#ifdef QLOGGING_HAVE_BACKTRACE
-#  include <qregularexpression.h>
-#  include <cxxabi.h>
-#  include <execinfo.h>
-#endif
 #endif // !QT_BOOTSTRAPPED
 
 /*!
@@ -265,6 +280,165 @@ static const char emptyTokenC[] = "";
 
 static const char defaultPattern[] = "%{if-category}%{category}: %{endif}%{message}";
 
+#ifdef QLOGGING_HAVE_BACKTRACE
+// largest depth= of all patterns ever set, 0 if none uses %{backtrace}
+static QAtomicInt requiredBacktraceDepth{0};
+#endif
+
+// placeholder put in the cached time format instead of "zzz", patched with milliseconds per message
+static const QChar msMarkerC(0xE000);
+static const char16_t msMarkerTextC[] = u"\uE000\uE000\uE000";
+
+/*!
+    \internal
+    Replaces every "zzz" of \a format by a quoted marker, so that the time can be
+    formatted once per second and only the milliseconds are patched per message.
+    Returns false when the output may depend on anything finer than "zzz".
+*/
+static bool compileTimeFormat(const QString &format, QString *cachedFormat, int *msCount)
+{
+    const QLatin1Char quote('\'');
+    QString result;
+    int count = 0;
+    bool inQuote = false;
+    for (int i = 0; i < format.size(); ++i) {
+        const QChar c = format.at(i);
+        if (c == msMarkerC)
+            return false;
+        if (c == quote) {
+            result.append(c);
+            if (i + 1 < format.size() && format.at(i + 1) == quote) {
+                // '' is an escaped quote both inside and outside of quoted text
+                result.append(quote);
+                ++i;
+            } else {
+                inQuote = !inQuote;
+            }
+            continue;
+        }
+        if (inQuote || c != QLatin1Char('z')) {
+            result.append(c);
+            continue;
+        }
+        int run = 1;
+        while (i + run < format.size() && format.at(i + run) == QLatin1Char('z'))
+            ++run;
+        // "z" prints a variable number of digits, other runs are left to QDateTime
+        if (run != 3)
+            return false;
+        // an adjacent quote would merge with the marker's quotes into an escaped quote
+        if ((i > 0 && format.at(i - 1) == quote)
+                || (i + run < format.size() && format.at(i + run) == quote))
+            return false;
+        result.append(quote);
+        result.append(QStringView(msMarkerTextC));
+        result.append(quote);
+        ++count;
+        i += run - 1;
+    }
+    if (inQuote)
+        return false;
+    *cachedFormat = result;
+    *msCount = count;
+    return true;
+}
+
+/*!
+    \internal
+    Turns the token list into emitters, resolving the arguments of %{time} / %{backtrace}
+    and the jump target of each %{if-*} once instead of per message.
+*/
+static void compilePattern(McMessagePattern *pattern)
+{
+    static QAtomicInteger<quint64> nextId{0};
+    pattern->id = ++nextId;
+    pattern->reserveSize.storeRelaxed(0);
+    pattern->emitters.clear();
+
+    using Emitter = McMessagePattern::Emitter;
+    int timeArgsIdx = 0;
+#ifdef QLOGGING_HAVE_BACKTRACE
+    int backtraceArgsIdx = 0;
+#endif
+    QVector<int> pendingIfs;
+    for (int i = 0; pattern->tokens[i] != nullptr; ++i) {
+        const char *token = pattern->tokens[i];
+        Emitter e;
+        if (token == messageTokenC) {
+            e.kind = Emitter::Message;
+        } else if (token == categoryTokenC) {
+            e.kind = Emitter::Category;
+        } else if (token == typeTokenC) {
+            e.kind = Emitter::Type;
+        } else if (token == fileTokenC) {
+            e.kind = Emitter::File;
+        } else if (token == lineTokenC) {
+            e.kind = Emitter::Line;
+        } else if (token == functionTokenC) {
+            e.kind = Emitter::Function;
+        } else if (token == pidTokenC) {
+            e.kind = Emitter::Pid;
+        } else if (token == appnameTokenC) {
+            e.kind = Emitter::AppName;
+        } else if (token == threadidTokenC) {
+            e.kind = Emitter::ThreadId;
+        } else if (token == qthreadptrTokenC) {
+            e.kind = Emitter::QThreadPtr;
+#ifdef QLOGGING_HAVE_BACKTRACE
+        } else if (token == backtraceTokenC) {
+            e.kind = Emitter::Backtrace;
+            e.argIndex = backtraceArgsIdx++;
+#endif
+        } else if (token == timeTokenC) {
+            e.text = pattern->timeArgs.at(timeArgsIdx++);
+            if (e.text == QLatin1String("process"))
+                e.kind = Emitter::TimeProcess;
+            else if (e.text == QLatin1String("boot"))
+                e.kind = Emitter::TimeBoot;
+            else if (e.text.isEmpty())
+                e.kind = Emitter::TimeIso;
+            else if (compileTimeFormat(e.text, &e.cachedFormat, &e.msCount))
+                e.kind = Emitter::TimeCached;
+            else
+                e.kind = Emitter::TimeFormat;
+        } else if (token == ifCategoryTokenC) {
+            e.kind = Emitter::IfCategory;
+        } else if (token == ifDebugTokenC) {
+            e.kind = Emitter::IfDebug;
+        } else if (token == ifInfoTokenC) {
+            e.kind = Emitter::IfInfo;
+        } else if (token == ifWarningTokenC) {
+            e.kind = Emitter::IfWarning;
+        } else if (token == ifCriticalTokenC) {
+            e.kind = Emitter::IfCritical;
+        } else if (token == ifFatalTokenC) {
+            e.kind = Emitter::IfFatal;
+        } else if (token == endifTokenC) {
+            e.kind = Emitter::Endif;
+        } else if (*token == '\0') {
+            // unknown placeholder or unsupported %{backtrace}
+            continue;
+        } else {
+            e.kind = Emitter::Literal;
+            e.text = QLatin1String(token);
+            e.utf8Text = e.text.toUtf8();
+        }
+
+        if (e.kind >= Emitter::IfCategory && e.kind <= Emitter::IfFatal) {
+            pendingIfs.append(pattern->emitters.size());
+        } else if (e.kind == Emitter::Endif) {
+            // a skipped block always ends at the next %{endif}, even for (invalid) nested ifs
+            for (auto idx : qAsConst(pendingIfs))
+                pattern->emitters[idx].skipTo = pattern->emitters.size();
+            pendingIfs.clear();
+        }
+        pattern->emitters.append(e);
+    }
+    // missing %{endif}: skip to the end
+    for (auto idx : qAsConst(pendingIfs))
+        pattern->emitters[idx].skipTo = pattern->emitters.size();
+}
+
 
 
 
@@ -391,6 +565,10 @@ void McMessagePattern::setPattern(const QString &pattern)
                 m = separatorRx.match(lexeme);
                 if (m.hasMatch())
                     backtraceSeparator = m.captured(1);
+                for (int required = requiredBacktraceDepth.loadRelaxed(); backtraceDepth > required;) {
+                    if (requiredBacktraceDepth.testAndSetRelaxed(required, backtraceDepth, required))
+                        break;
+                }
                 BacktraceParams backtraceParams;
                 backtraceParams.backtraceDepth = backtraceDepth;
                 backtraceParams.backtraceSeparator = backtraceSeparator;
@@ -444,48 +622,306 @@ void McMessagePattern::setPattern(const QString &pattern)
     literals = new const char*[static_cast<qulonglong>(literalsVar.size() + 1)];
     literals[literalsVar.size()] = nullptr;
     memcpy(literals, literalsVar.constData(), static_cast<qulonglong>(literalsVar.size()) * sizeof(const char*));
+
+    compilePattern(this);
 }
 
-QString format(McMessagePatternPtr pattern, QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept 
+/*!
+    \internal
+    Output of formatUtf8(): appends straight to the UTF-8 batch of an appender,
+    the message is encoded once instead of being built as UTF-16 first.
+*/
+class McUtf8Sink
 {
-    QString message;
+public:
+    explicit McUtf8Sink(QByteArray &out) noexcept
+        : m_out(out)
+    {}
 
-    if (!pattern) {
-        // after destruction of static QMessagePattern instance
-        message.append(str);
-        return message;
+    void append(const QString &str) noexcept { McFileUtils::appendUtf8(m_out, str); }
+    void append(QLatin1String str) noexcept
+    {
+        for (char c : str) {
+            auto u = static_cast<uchar>(c);
+            if (u < 0x80) {
+                m_out.append(c);
+            } else {
+                m_out.append(static_cast<char>(0xc0 | (u >> 6)));
+                m_out.append(static_cast<char>(0x80 | (u & 0x3f)));
+            }
+        }
     }
+    QByteArray &bytes() noexcept { return m_out; }
+
+private:
+    QByteArray &m_out;
+};
 
-    bool skip = false;
+static inline void appendLiteral(QString &message, const McMessagePattern::Emitter &e)
+{
+    message.append(e.text);
+}
+
+static inline void appendLiteral(McUtf8Sink &message, const McMessagePattern::Emitter &e)
+{
+    message.bytes().append(e.utf8Text);
+}
 
 #ifndef QT_BOOTSTRAPPED
-    int timeArgsIdx = 0;
-#ifdef QLOGGING_HAVE_BACKTRACE
-    int backtraceArgsIdx = 0;
-#endif
-#endif
+// the thread id cannot change during the lifetime of a thread
+static const QString &currentThreadIdString()
+{
+    thread_local const QString tid = QString::number(currentThreadId());
+    return tid;
+}
 
-    // we do not convert file, function, line literals to local encoding due to overhead
-    for (int i = 0; pattern->tokens[i] != nullptr; ++i) {
-        const char *token = pattern->tokens[i];
-        if (token == endifTokenC) {
-            skip = false;
-        } else if (skip) {
-            // we skip adding messages, but we have to iterate over
-            // timeArgsIdx and backtraceArgsIdx anyway
+#if QT_CONFIG(datestring)
+struct McTimeCache
+{
+    qint64 second{std::numeric_limits<qint64>::min()};
+    QString text;
+    QVarLengthArray<int, 2> msPositions;
+    QByteArray utf8;                         // text with the markers replaced by "000"
+    QVarLengthArray<int, 2> utf8MsPositions; // byte offsets of the milliseconds in utf8
+};
+
+static inline void patchMilliseconds(char *data, int ms)
+{
+    data[0] = static_cast<char>('0' + ms / 100);
+    data[1] = static_cast<char>('0' + ms / 10 % 10);
+    data[2] = static_cast<char>('0' + ms % 10);
+}
+
+template<typename Sink>
+static void appendCachedTime(const McMessagePattern &pattern, int index, qint64 msecs, Sink &message)
+{
+    using Emitter = McMessagePattern::Emitter;
+    const Emitter &e = pattern.emitters.at(index);
+
+    // per thread, so that formatting never takes a lock
+    thread_local QHash<quint64, McTimeCache> caches;
+
+    qint64 second = msecs / 1000;
+    if (msecs % 1000 < 0)
+        --second;
+    const int ms = static_cast<int>(msecs - second * 1000);
+
+    McTimeCache &cache = caches[(pattern.id << 16) | static_cast<quint64>(index)];
+    if (cache.second != second) {
+        const QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(second * 1000);
+        cache.msPositions.clear();
+        if (e.kind == Emitter::TimeIso) {
+            cache.text = dateTime.toString(Qt::ISODate);
+        } else {
+            cache.text = dateTime.toString(e.cachedFormat);
+            const QStringView marker(msMarkerTextC);
+            for (int pos = cache.text.indexOf(marker); pos != -1; pos = cache.text.indexOf(marker, pos + 3))
+                cache.msPositions.append(pos);
+            if (cache.msPositions.size() != e.msCount) {
+                // the marker was not printed verbatim, never use the cache for this format
+                cache.second = std::numeric_limits<qint64>::min();
+                message.append(QDateTime::fromMSecsSinceEpoch(msecs).toString(e.text));
+                return;
+            }
+        }
+        cache.second = second;
+        cache.utf8.clear();
+        cache.utf8MsPositions.clear();
+    }
+
+    if constexpr (std::is_same_v<Sink, McUtf8Sink>) {
+        if (cache.utf8.isEmpty() && !cache.text.isEmpty()) {
+            // encoded lazily, only appenders writing UTF-8 batches need it
+            QString text = cache.text;
+            int last = 0;
+            qint64 bytes = 0;
+            for (int pos : cache.msPositions) {
+                for (int j = 0; j < 3; ++j)
+                    text[pos + j] = QLatin1Char('0');
+                bytes += McFileUtils::utf8Size(QStringView(text).mid(last, pos - last));
+                cache.utf8MsPositions.append(static_cast<int>(bytes));
+                last = pos;
+            }
+            cache.utf8 = text.toUtf8();
+        }
+        QByteArray &out = message.bytes();
+        const int base = out.size();
+        out.append(cache.utf8);
+        if (cache.utf8MsPositions.isEmpty())
+            return;
+        char *data = out.data() + base;
+        for (int pos : cache.utf8MsPositions)
+            patchMilliseconds(data + pos, ms);
+    } else {
+        const int base = message.size();
+        message.append(cache.text);
+        if (cache.msPositions.isEmpty())
+            return;
+        QChar *data = message.data() + base;
+        for (int pos : cache.msPositions) {
+            data[pos] = QLatin1Char(static_cast<char>('0' + ms / 100));
+            data[pos + 1] = QLatin1Char(static_cast<char>('0' + ms / 10 % 10));
+            data[pos + 2] = QLatin1Char(static_cast<char>('0' + ms % 10));
+        }
+    }
+}
+#endif // QT_CONFIG(datestring)
+#endif // !QT_BOOTSTRAPPED
+
+qint64 currentThreadId() noexcept
+{
 #ifndef QT_BOOTSTRAPPED
-            if (token == timeTokenC)
-                timeArgsIdx++;
+    thread_local const qint64 tid = mc_gettid();
+    return tid;
+#else
+    return 0;
+#endif
+}
+
+QVector<void *> captureBacktrace() noexcept
+{
+    QVector<void *> frames;
 #ifdef QLOGGING_HAVE_BACKTRACE
-            else if (token == backtraceTokenC)
-                backtraceArgsIdx++;
+    const int depth = requiredBacktraceDepth.loadRelaxed();
+    if (depth == 0)
+        return frames;
+    // besides Qt's own 8 frames of qDebug() leave room for the handler and appender frames of McLog
+    frames.resize(16 + depth);
+    const int n = backtrace(frames.data(), frames.size());
+    frames.resize(qMax(n, 0));
 #endif
+    return frames;
+}
+
+#ifdef QLOGGING_HAVE_BACKTRACE
+struct BacktraceSymbol
+{
+    bool matched{false};
+    QString library;
+    QString function; // demangled and cleaned up
+};
+
+/*!
+    \internal
+    Resolves one return address. backtrace_symbols() and demangling are by far the most
+    expensive part of %{backtrace}, the result is cached per address for the lifetime of the process.
+*/
+static BacktraceSymbol symbolizeFrame(void *address)
+{
+    static QMutex mutex;
+    static QHash<void *, BacktraceSymbol> cache;
+    QMutexLocker locker(&mutex);
+    auto it = cache.constFind(address);
+    if (it != cache.constEnd())
+        return it.value();
+
+    // The results of backtrace_symbols looks like this:
+    //    /lib/libc.so.6(__libc_start_main+0xf3) [0x4a937413]
+    // The offset and function name are optional.
+    // This regexp tries to extract the library name (without the path) and the function name.
+    static const QRegularExpression rx(QStringLiteral("^(?:[^(]*/)?([^(/]+)\\(([^+]*)(?:[\\+[a-f0-9x]*)?\\) \\[[a-f0-9x]*\\]$"));
+
+    BacktraceSymbol symbol;
+    char **strings = backtrace_symbols(&address, 1);
+    if (strings) {
+        QRegularExpressionMatch m = rx.match(QString::fromLatin1(strings[0]));
+        free(strings);
+        if (m.hasMatch()) {
+            symbol.matched = true;
+            symbol.library = m.captured(1);
+            symbol.function = m.captured(2);
+            if (symbol.function.startsWith(QLatin1String("_Z"))) {
+                char *demangled = abi::__cxa_demangle(symbol.function.toUtf8().constData(), nullptr, nullptr, nullptr);
+                if (demangled) {
+                    symbol.function = QString::fromUtf8(mcCleanupFuncinfo(demangled));
+                    free(demangled);
+                }
+            }
+        }
+    }
+    cache.insert(address, symbol);
+    return symbol;
+}
+
+static QString formatBacktraceForLogMessage(const McMessagePattern::BacktraceParams &backtraceParams,
+                                            const char *function,
+                                            const QVector<void *> &addresses)
+{
+    static const QString qtCoreLibrary = QStringLiteral("Qt" QT_STRINGIFY(QT_VERSION_MAJOR) "Core");
+
+    QStringList frames;
+    for (int i = 0; i < addresses.size() && frames.size() < backtraceParams.backtraceDepth; ++i) {
+        const BacktraceSymbol symbol = symbolizeFrame(addresses.at(i));
+        if (!symbol.matched) {
+            // innermost, unknown frames are usually the logging framework itself
+            if (!frames.isEmpty())
+                frames.append(QStringLiteral("???"));
+            continue;
+        }
+        // skip the trace from QtCore and McLog that are because of the qDebug itself
+        if (frames.isEmpty()
+                && (symbol.library.contains(QLatin1String("McLogQt"))
+                    || (symbol.library.contains(qtCoreLibrary)
+                        && (symbol.function.isEmpty()
+                            || symbol.function.contains(QLatin1String("Message"), Qt::CaseInsensitive)
+                            || symbol.function.contains(QLatin1String("QDebug")))))) {
+            continue;
+        }
+        if (symbol.function.isEmpty())
+            frames.append(QLatin1Char('?') + symbol.library + QLatin1Char('?'));
+        else
+            frames.append(symbol.function);
+    }
+    if (frames.isEmpty())
+        return QString();
+
+    // if the first frame is unknown, replace it with the context function
+    if (function && frames.at(0).startsWith(QLatin1Char('?')))
+        frames[0] = QString::fromUtf8(mcCleanupFuncinfo(function));
+
+    return frames.join(backtraceParams.backtraceSeparator);
+}
 #endif
-        } else if (token == messageTokenC) {
+
+// record is null when formatting on the logging thread itself.
+// Sink is a QString or a McUtf8Sink appending to the batch of an appender
+template<typename Sink>
+static void formatImpl(McMessagePatternPtr pattern,
+                       QtMsgType type,
+                       const QMessageLogContext &context,
+                       const QString &str,
+                       const McLogRecord *record,
+                       Sink &message) noexcept
+{
+    constexpr bool isUtf16 = std::is_same_v<Sink, QString>;
+
+    if (!pattern) {
+        // after destruction of static QMessagePattern instance
+        message.append(str);
+        return;
+    }
+
+    // the output of a pattern has nearly the same length every time, avoid growing step by step
+    if constexpr (isUtf16)
+        message.reserve(pattern->reserveSize.loadRelaxed() + str.size());
+
+    using Emitter = McMessagePattern::Emitter;
+    const QVector<Emitter> &emitters = pattern->emitters;
+
+    // we do not convert file, function, line literals to local encoding due to overhead
+    for (int i = 0; i < emitters.size(); ++i) {
+        const Emitter &e = emitters.at(i);
+        switch (e.kind) {
+        case Emitter::Literal:
+            appendLiteral(message, e);
+            break;
+        case Emitter::Message:
             message.append(str);
-        } else if (token == categoryTokenC) {
+            break;
+        case Emitter::Category:
             message.append(QLatin1String(context.category));
-        } else if (token == typeTokenC) {
+            break;
+        case Emitter::Type:
             switch (type) {
             case QtDebugMsg:   message.append(QLatin1String("DEBUG")); break;
 #if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
@@ -495,81 +931,97 @@ QString format(McMessagePatternPtr pattern, QtMsgType type, const QMessageLogCon
             case QtCriticalMsg:message.append(QLatin1String("CRITICAL")); break;
             case QtFatalMsg:   message.append(QLatin1String("FATAL")); break;
             }
-        } else if (token == fileTokenC) {
+            break;
+        case Emitter::File:
             if (context.file)
                 message.append(QLatin1String(context.file));
             else
                 message.append(QLatin1String("unknown"));
-        } else if (token == lineTokenC) {
+            break;
+        case Emitter::Line:
             message.append(QString::number(context.line));
-        } else if (token == functionTokenC) {
+            break;
+        case Emitter::Function:
             if (context.function)
                 message.append(QString::fromLatin1(mcCleanupFuncinfo(context.function)));
             else
                 message.append(QLatin1String("unknown"));
+            break;
 #ifndef QT_BOOTSTRAPPED
-        } else if (token == pidTokenC) {
+        case Emitter::Pid:
             message.append(QString::number(QCoreApplication::applicationPid()));
-        } else if (token == appnameTokenC) {
+            break;
+        case Emitter::AppName:
             message.append(QCoreApplication::applicationName());
-        } else if (token == threadidTokenC) {
+            break;
+        case Emitter::ThreadId:
             // print the TID as decimal
-            message.append(QString::number(mc_gettid()));
-        } else if (token == qthreadptrTokenC) {
+            if (record)
+                message.append(QString::number(record->threadId));
+            else
+                message.append(currentThreadIdString());
+            break;
+        case Emitter::QThreadPtr:
             message.append(QLatin1String("0x"));
-            message.append(QString::number(qlonglong(QThread::currentThread()->currentThread()), 16));
+            if (record)
+                message.append(QString::number(qlonglong(record->qthreadPtr), 16));
+            else
+                message.append(QString::number(qlonglong(QThread::currentThread()->currentThread()), 16));
+            break;
 #ifdef QLOGGING_HAVE_BACKTRACE
-        } else if (token == backtraceTokenC) {
-            QMessagePattern::BacktraceParams backtraceParams = pattern->backtraceArgs.at(backtraceArgsIdx);
-            backtraceArgsIdx++;
-            message.append(formatBacktraceForLogMessage(backtraceParams, context.function));
+        case Emitter::Backtrace:
+            message.append(formatBacktraceForLogMessage(pattern->backtraceArgs.at(e.argIndex),
+                                                        context.function,
+                                                        record ? record->backtrace : captureBacktrace()));
+            break;
 #endif
-        } else if (token == timeTokenC) {
-            QString timeFormat = pattern->timeArgs.at(timeArgsIdx);
-            timeArgsIdx++;
-            if (timeFormat == QLatin1String("process")) {
-                    quint64 ms = static_cast<quint64>(pattern->timer.elapsed());
-                    message.append(
-# if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
-                                QString::asprintf
-# else
-                                QString().sprintf
-# endif
-                                   ("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
-            } else if (timeFormat ==  QLatin1String("boot")) {
-                // just print the milliseconds since the elapsed timer reference
-                // like the Linux kernel does
+        case Emitter::TimeProcess: {
+            quint64 ms = static_cast<quint64>(
+                record ? record->monotonicMsecs - pattern->timer.msecsSinceReference()
+                       : pattern->timer.elapsed());
+            message.append(QString::asprintf("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
+            break;
+        }
+        case Emitter::TimeBoot: {
+            // just print the milliseconds since the elapsed timer reference
+            // like the Linux kernel does
+            uint ms = 0;
+            if (record) {
+                ms = static_cast<uint>(record->monotonicMsecs);
+            } else {
                 QElapsedTimer now;
                 now.start();
-                uint ms = static_cast<uint>(now.msecsSinceReference());
-                message.append(
-# if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
-                            QString::asprintf
-# else
-                            QString().sprintf
-# endif
-                               ("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
-#if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
+                ms = static_cast<uint>(now.msecsSinceReference());
+            }
+            message.append(QString::asprintf("%6d.%03d", uint(ms / 1000), uint(ms % 1000)));
+            break;
+        }
 #if QT_CONFIG(datestring)
-            } else if (timeFormat.isEmpty()) {
-                    message.append(QDateTime::currentDateTime().toString(Qt::ISODate));
-            } else {
-                message.append(QDateTime::currentDateTime().toString(timeFormat));
+        case Emitter::TimeIso:
+        case Emitter::TimeCached:
+            appendCachedTime(*pattern,
+                             i,
+                             record ? record->msecsSinceEpoch
+                                    : QDateTime::currentMSecsSinceEpoch(),
+                             message);
+            break;
+        case Emitter::TimeFormat:
+            if (record)
+                message.append(QDateTime::fromMSecsSinceEpoch(record->msecsSinceEpoch).toString(e.text));
+            else
+                message.append(QDateTime::currentDateTime().toString(e.text));
+            break;
 #endif // QT_CONFIG(datestring)
-#else
-            } else if (timeFormat.isEmpty()) {
-                    message.append(QDateTime::currentDateTime().toString(Qt::ISODate));
-            } else {
-                message.append(QDateTime::currentDateTime().toString(timeFormat));
-#endif
-            }
 #endif // !QT_BOOTSTRAPPED
-        } else if (token == ifCategoryTokenC) {
+        case Emitter::IfCategory:
             if (isDefaultCategory(context.category))
-                skip = true;
+                i = e.skipTo;
+            break;
 #define HANDLE_IF_TOKEN(LEVEL)  \
-        } else if (token == if##LEVEL##TokenC) { \
-            skip = type != Qt##LEVEL##Msg;
+        case Emitter::If##LEVEL: \
+            if (type != Qt##LEVEL##Msg) \
+                i = e.skipTo; \
+            break;
         HANDLE_IF_TOKEN(Debug)
 # if QT_VERSION >= QT_VERSION_CHECK(5, 5, 0)
         HANDLE_IF_TOKEN(Info)
@@ -578,11 +1030,32 @@ QString format(McMessagePatternPtr pattern, QtMsgType type, const QMessageLogCon
         HANDLE_IF_TOKEN(Critical)
         HANDLE_IF_TOKEN(Fatal)
 #undef HANDLE_IF_TOKEN
-        } else {
-            message.append(QLatin1String(token));
+        default:
+            break;
         }
     }
+    if constexpr (isUtf16)
+        pattern->reserveSize.storeRelaxed(message.size() - str.size());
+}
+
+QString format(McMessagePatternPtr pattern, QtMsgType type, const QMessageLogContext &context, const QString &str) noexcept
+{
+    QString message;
+    formatImpl(pattern, type, context, str, nullptr, message);
     return message;
 }
 
+QString format(McMessagePatternPtr pattern, const McLogRecord &record) noexcept
+{
+    QString message;
+    formatImpl(pattern, record.type, record.context(), record.message, &record, message);
+    return message;
+}
+
+void formatUtf8(McMessagePatternPtr pattern, const McLogRecord &record, QByteArray &out) noexcept
+{
+    McUtf8Sink sink(out);
+    formatImpl(pattern, record.type, record.context(), record.message, &record, sink);
+}
+
 }
@@ -25,15 +25,29 @@
 
 #include <QDateTime>
 #include <QDir>
-#include <QRegularExpression>
-#include <QTimer>
+#include <QFileInfo>
 
 #include <McIoc/Utils/Zip/McCompressor.h>
 
+#include "McLog/Utils/McFileUtils.h"
+#include "McLog/Utils/McLogMaintainer.h"
+#include "McLog/Utils/McLogTimeIndex.h"
+
 MC_STATIC()
 MC_REGISTER_BEAN_FACTORY(McLogPackager)
 MC_STATIC_END
 
+//! 预先拆分的压缩包路径，会被复制到后台任务中使用
+struct McLogPackager::Target
+{
+    QString dstPath;
+    QString fileNamePattern;
+    QString prefix;
+    QString timeFormat;
+    QString suffix;
+    bool hasTime{false};
+};
+
 MC_DECL_PRIVATE_DATA(McLogPackager)
 QList<QString> scanPaths;
 int maxDepth{1};
@@ -42,6 +56,9 @@ int ageNumeric{5};
 QList<QString> filters;
 QString dstPath;
 QString fileNamePattern;
+int sliceSize{256}; //!< 每个压缩包最多包含的文件数，处理完一批后重新排队
+McLogFileIndexPtr index;
+QSharedPointer<McLogPackager::Target> target;
 MC_DECL_PRIVATE_DATA_END
 
 McLogPackager::McLogPackager() noexcept
@@ -55,6 +72,21 @@ McLogPackager::~McLogPackager()
 
 void McLogPackager::finished() noexcept
 {
+    d->dstPath = Mc::toAbsolutePath(d->dstPath);
+    d->index = McLogFileIndexPtr::create(d->scanPaths, d->maxDepth, d->filters);
+    d->target = QSharedPointer<Target>::create();
+    d->target->dstPath = d->dstPath;
+    d->target->fileNamePattern = d->fileNamePattern;
+    d->target->hasTime = McFileUtils::parseTimePattern(d->fileNamePattern,
+                                                       d->target->prefix,
+                                                       d->target->timeFormat,
+                                                       d->target->suffix);
+    if (!d->target->hasTime) {
+        //! 序号需要加在扩展名之前
+        QFileInfo fileInfo(d->fileNamePattern);
+        d->target->prefix = fileInfo.completeBaseName();
+        d->target->suffix = fileInfo.suffix().isEmpty() ? QString() : "." + fileInfo.suffix();
+    }
     if (!d->age.endsWith("D", Qt::CaseInsensitive)) {
         MC_PRINT_ERR("age must endsWith 'D' for McLogDeleter property\n");
         return;
@@ -66,91 +98,83 @@ void McLogPackager::finished() noexcept
     if (isOk) {
         d->ageNumeric = num;
     }
-    d->dstPath = Mc::toAbsolutePath(d->dstPath);
 }
 
 void McLogPackager::execute() noexcept
 {
-    QMap<QString, QStringList> filePaths;
-    for (auto &scanPath : qAsConst(d->scanPaths)) {
-        auto path = Mc::toAbsolutePath(scanPath);
-        auto files = checkFiles(0, path);
-        if (files.isEmpty()) {
-            continue;
-        }
-        filePaths[path].append(files);
-    }
-    if (filePaths.isEmpty()) {
+    if (d->index.isNull()) {
         return;
     }
-    auto tarPath = newFilePath();
-    if (!McCompressor::compressFiles(tarPath, filePaths)) {
-        return;
-    }
-    for (auto &files : qAsConst(filePaths)) {
-        for (auto &file : files) {
-            qInfo() << "The file has packed. deleted:" << file;
-            QFile::remove(file);
-        }
-    }
+    auto cutoff = QDate::currentDate().addDays(-d->ageNumeric).startOfDay().toMSecsSinceEpoch();
+    auto index = d->index;
+    auto target = d->target;
+    auto sliceSize = qMax(1, d->sliceSize);
+    McLogMaintainer::post(
+        [index, target, cutoff, sliceSize]() { packFiles(index, target, cutoff, sliceSize); });
 }
 
-QStringList McLogPackager::checkFiles(int depth, const QString &path) noexcept
+void McLogPackager::packFiles(McLogFileIndexConstPtrRef index,
+                              const QSharedPointer<Target> &target,
+                              qint64 cutoff,
+                              int sliceSize) noexcept
 {
-    auto curDepth = depth + 1;
-    if (curDepth > d->maxDepth) {
-        return QStringList();
+    if (McLogMaintainer::isShuttingDown()) {
+        return; //!< 下次启动后再处理
     }
-    QStringList filePaths;
-    QDir dir(path);
-    auto fileInfos = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-    for (auto &fileInfo : qAsConst(fileInfos)) {
-        auto absPath = fileInfo.absoluteFilePath();
-        if (fileInfo.isDir()) {
-            filePaths.append(checkFiles(curDepth, absPath));
+    index->ensureScanned();
+    auto taken = index->takeExpired(cutoff, sliceSize);
+    if (taken.isEmpty()) {
+        return;
+    }
+    QList<McLogFileIndex::Entry> entries;
+    QMap<QString, QStringList> filePaths;
+    for (auto &entry : taken) {
+        if (!index->recheckExpired(entry, cutoff)) {
             continue;
         }
-        if (!fileNameCheck(fileInfo.fileName())) {
-            continue;
+        entries.append(entry);
+        filePaths[entry.basePath].append(entry.filePath);
+    }
+    if (!entries.isEmpty()) {
+        auto tarPath = newFilePath(*target);
+        //! 失败的文件已从索引中取出，等待下一次完整扫描时再处理
+        if (!McCompressor::compressFiles(tarPath, filePaths)) {
+            MC_PRINT_ERR("failed to pack files into: %s\n", qPrintable(tarPath));
+            return;
         }
-        auto fileDate = fileInfo.lastModified().date();
-        auto curDate = QDate::currentDate();
-        auto day = fileDate.daysTo(curDate);
-        if (day > d->ageNumeric) {
-            filePaths.append(absPath);
+        for (auto &entry : entries) {
+            //! 打包期间又被写入的文件保留，压缩包中只是它较早的内容
+            auto packedLastModified = entry.lastModified;
+            if (!index->recheckExpired(entry, cutoff) || entry.lastModified != packedLastModified) {
+                continue;
+            }
+            qInfo() << "The file has packed. deleted:" << entry.filePath;
+            QFile::remove(entry.filePath);
+            QFile::remove(McLogTimeIndex::indexPath(entry.filePath)); //!< 同时删除时间索引
+            McLogFileIndex::fileRemoved(entry.filePath);
         }
+        McLogFileIndex::fileAdded(tarPath);
     }
-    return filePaths;
-}
-
-bool McLogPackager::fileNameCheck(const QString &fileName) noexcept
-{
-    if (d->filters.isEmpty()) {
-        return true;
-    }
-    for (auto &filter : qAsConst(d->filters)) {
-        QRegularExpression reg(filter);
-        auto match = reg.match(fileName);
-        if (!match.capturedTexts().isEmpty()) {
-            return true;
-        }
+    if (taken.size() < sliceSize) {
+        return;
     }
-    return false;
+    McLogMaintainer::post(
+        [index, target, cutoff, sliceSize]() { packFiles(index, target, cutoff, sliceSize); });
 }
 
-QString McLogPackager::newFilePath() const noexcept
+QString McLogPackager::newFilePath(const Target &target) noexcept
 {
-    QRegularExpression re(R"((.*)%\{time (.*?)\}(.*))");
-    auto match = re.match(d->fileNamePattern);
-
-    QDir dir(d->dstPath);
-    if (!match.hasMatch()) {
-        return dir.absoluteFilePath(d->fileNamePattern);
+    QDir dir(target.dstPath);
+    QString prefix = target.prefix;
+    if (target.hasTime) {
+        prefix += QDateTime::currentDateTime().toString(target.timeFormat);
     }
-
-    auto list = match.capturedTexts();
-    return dir.absoluteFilePath(list.at(1) + QDateTime::currentDateTime().toString(list.at(2))
-                                + list.at(3));
+    auto filePath = dir.absoluteFilePath(prefix + target.suffix);
+    //! 同一时刻可能打包多批文件，已存在时追加序号，避免覆盖上一批
+    for (int i = 1; QFileInfo::exists(filePath); ++i) {
+        filePath = dir.absoluteFilePath(QStringLiteral("%1_%2%3").arg(prefix).arg(i).arg(target.suffix));
+    }
+    return filePath;
 }
 
 #include "moc_McLogPackager.cpp"
@@ -5,7 +5,9 @@ SUBDIRS += McIoc \
     McLogQt \
     McOrm \
     McQuickBoot \
-    Examples
+    Tools \
+    Examples \
+    Tests
 
 #SUBDIRS += McQuickBoot
 #McQuickBoot.depends += McIoc
@@ -62,10 +62,13 @@ SOURCES += \
     $$PWD/src/Utils/Callback/McCppAsyncCallback.cpp \
     $$PWD/src/Utils/Callback/McCppSyncCallback.cpp \
     $$PWD/src/Utils/McCancel.cpp \
+    $$PWD/src/Utils/McFuture.cpp \
     $$PWD/src/Utils/McJsonUtils.cpp \
     $$PWD/src/BeanDefinitionReader/McConfigurationFileBeanDefinitionReader.cpp \
     $$PWD/src/Utils/McPause.cpp \
     $$PWD/src/Utils/McProgress.cpp \
+    $$PWD/src/Utils/McRequestMetrics.cpp \
+    $$PWD/src/Utils/McStream.cpp \
     $$PWD/src/Utils/Response/McResponseHandlerFactory.cpp
 
 HEADERS +=  \
@@ -113,10 +116,14 @@ HEADERS +=  \
     $$PWD/include/McBoot/Utils/Callback/Impl/McCppAsyncCallback.h \
     $$PWD/include/McBoot/Utils/Callback/Impl/McCppSyncCallback.h \
     $$PWD/include/McBoot/Utils/McCancel.h \
+    $$PWD/include/McBoot/Utils/McCoroutine.h \
+    $$PWD/include/McBoot/Utils/McFuture.h \
     $$PWD/include/McBoot/Utils/McJsonUtils.h \
     $$PWD/include/McBoot/BeanDefinitionReader/impl/McConfigurationFileBeanDefinitionReader.h \
     $$PWD/include/McBoot/Utils/McPause.h \
     $$PWD/include/McBoot/Utils/McProgress.h \
+    $$PWD/include/McBoot/Utils/McRequestMetrics.h \
+    $$PWD/include/McBoot/Utils/McStream.h \
     $$PWD/include/McBoot/Utils/Response/IMcResponseHandler.h \
     $$PWD/include/McBoot/Utils/Response/McResponseHandlerFactory.h
 
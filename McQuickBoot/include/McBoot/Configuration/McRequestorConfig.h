@@ -37,6 +37,8 @@ class McRequestorConfig : public QObject
     Q_PROPERTY(bool autoIncrease READ autoIncrease WRITE setAutoIncrease)
     Q_PROPERTY(bool waitThreadPoolDone READ waitThreadPoolDone WRITE setWaitThreadPoolDone)
     Q_PROPERTY(int threadPoolWaitTimeout READ threadPoolWaitTimeout WRITE setThreadPoolWaitTimeout)
+    Q_PROPERTY(bool metricsEnabled READ metricsEnabled WRITE setMetricsEnabled)
+    Q_PROPERTY(QString metricsDumpPath READ metricsDumpPath WRITE setMetricsDumpPath)
 public:
     Q_INVOKABLE McRequestorConfig(QObject *parent = nullptr) noexcept;
     ~McRequestorConfig();
@@ -53,6 +55,12 @@ public:
     int threadPoolWaitTimeout() const noexcept;
     void setThreadPoolWaitTimeout(int val) noexcept;
 
+    bool metricsEnabled() const noexcept;
+    void setMetricsEnabled(bool val) noexcept;
+
+    QString metricsDumpPath() const noexcept;
+    void setMetricsDumpPath(const QString &val) noexcept;
+
 private:
     MC_DECL_PRIVATE(McRequestorConfig)
 };
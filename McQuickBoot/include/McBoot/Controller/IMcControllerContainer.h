@@ -45,6 +45,8 @@ public:
     virtual QVariant invoke(const QString &uri,
                             const QVariantMap &data,
                             const McRequest &request) noexcept = 0;
+    //! uri是否对应已注册controller的方法，不检查参数
+    virtual bool hasRoute(const QString &uri) const noexcept = 0;
 };
 
 MC_DECL_METATYPE(IMcControllerContainer)
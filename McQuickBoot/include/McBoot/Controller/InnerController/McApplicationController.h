@@ -23,6 +23,7 @@
  */
 #pragma once
 
+#include <QJsonObject>
 #include <QObject>
 
 #include "../../McBootGlobal.h"
@@ -52,6 +53,19 @@ public:
      * \return 
      */
     Q_INVOKABLE QString filePath() const noexcept;
+    /*!
+     * \brief metrics
+     * 
+     * 获取每个路由的请求次数、错误次数以及排队、执行、回调三个阶段的耗时分布，单位：微秒
+     * \return 
+     */
+    Q_INVOKABLE QJsonObject metrics() const noexcept;
+    /*!
+     * \brief resetMetrics
+     * 
+     * 清空已统计的数据
+     */
+    Q_INVOKABLE void resetMetrics() noexcept;
     
 private:
     MC_DECL_PRIVATE(McApplicationController)
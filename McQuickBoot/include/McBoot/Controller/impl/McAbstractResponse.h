@@ -26,9 +26,12 @@
 #include "../../Utils/McCancel.h"
 #include "../../Utils/McPause.h"
 #include "../../Utils/McProgress.h"
+#include "../../Utils/McStream.h"
 
 MC_FORWARD_DECL_CLASS(IMcResponseHandler);
 
+struct McRouteMetrics;
+
 MC_FORWARD_DECL_PRIVATE_DATA(McAbstractResponse);
 
 /*!
@@ -67,6 +70,10 @@ protected:
 
     virtual void callCallback() noexcept = 0;
     virtual void callError() noexcept = 0;
+    virtual void callChunk(const QVariant &chunk) noexcept = 0;
+    virtual void callComplete() noexcept = 0;
+    //! 无论回调是否被调用，请求结束时都会调用此函数
+    virtual void callFinished(bool isError) noexcept;
 
     QVariant body() const noexcept;
     void setBody(const QVariant &var) noexcept;
@@ -76,9 +83,14 @@ protected:
     McProgress &getProgress() const noexcept;
     McCancel &getCancel() const noexcept;
     McPause &getPause() const noexcept;
+    McStream &getStream() const noexcept;
 
 private:
     void call() noexcept;
+    bool postChunk(const QVariant &chunk) noexcept;
+    void postComplete() noexcept;
+    bool isInternalError() const noexcept;
+    void setMetrics(McRouteMetrics *metrics, qint64 bodyTime) noexcept;
 
 private:
     MC_DECL_PRIVATE(McAbstractResponse)
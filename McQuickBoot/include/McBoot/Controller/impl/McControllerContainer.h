@@ -63,6 +63,7 @@ public:
     QVariant invoke(const QString &uri,
                     const QVariantMap &data,
                     const McRequest &request) noexcept override;
+    bool hasRoute(const QString &uri) const noexcept override;
 
 private:
     bool splitBeanAndFunc(const QString &uri,
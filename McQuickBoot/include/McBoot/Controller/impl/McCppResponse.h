@@ -25,6 +25,9 @@
 
 #include "McAbstractResponse.h"
 
+#include <functional>
+
+#include <QFuture>
 #include <QPointer>
 
 MC_FORWARD_DECL_PRIVATE_DATA(McCppResponse);
@@ -53,6 +56,16 @@ public:
 
     QPointer<McCppResponse> capture();
 
+    using Continuation = std::function<void(const QVariant &body, bool isError)>;
+    /*!
+     * \brief addContinuation
+     * 请求结束时在发出结果的线程上直接调用func，不经过QSlotObject和事件循环，
+     * 供协程、future等适配层使用。如果请求已经结束，则立即在当前线程调用
+     */
+    void addContinuation(const Continuation &func) noexcept;
+    //! 请求结束时完成的future，出错时结果为McResultPtr
+    QFuture<QVariant> future() noexcept;
+
     template<typename Func>
     McCppResponse &then(const typename QtPrivate::FunctionPointer<Func>::Object *recever,
                         Func callback) noexcept
@@ -297,9 +310,98 @@ public:
         return *this;
     }
 
+    template<typename Func>
+    McCppResponse &chunk(const typename QtPrivate::FunctionPointer<Func>::Object *recever,
+                         Func callback) noexcept
+    {
+        typedef QtPrivate::FunctionPointer<Func> FuncType;
+
+        Q_STATIC_ASSERT_X(
+            int(FuncType::ArgumentCount) <= 1,
+            "The number of parameters of chunk callback can only be less than or equal to 1");
+
+        setChunkCallback(McCppAsyncCallback::build(recever, callback));
+        return *this;
+    }
+    template<typename Func>
+    typename std::enable_if<int(QtPrivate::FunctionPointer<Func>::ArgumentCount) >= 0
+                                && !QtPrivate::FunctionPointer<Func>::IsPointerToMemberFunction,
+                            McCppResponse &>::type
+    chunk(Func callback) noexcept
+    {
+        typedef QtPrivate::FunctionPointer<Func> FuncType;
+
+        Q_STATIC_ASSERT_X(
+            int(FuncType::ArgumentCount) <= 1,
+            "The number of parameters of chunk callback can only be less than or equal to 1");
+
+        setChunkCallback(McCppAsyncCallback::build(callback));
+        return *this;
+    }
+    template<typename Func>
+    typename std::enable_if<QtPrivate::FunctionPointer<Func>::ArgumentCount == -1,
+                            McCppResponse &>::type
+    chunk(Func callback) noexcept
+    {
+        typedef McPrivate::LambdaType<Func> FuncType;
+
+        Q_STATIC_ASSERT_X(
+            int(FuncType::ArgumentCount) <= 1,
+            "The number of parameters of chunk callback can only be less than or equal to 1");
+
+        setChunkCallback(McCppAsyncCallback::build(callback));
+        return *this;
+    }
+
+    template<typename Func>
+    McCppResponse &complete(const typename QtPrivate::FunctionPointer<Func>::Object *recever,
+                            Func callback) noexcept
+    {
+        typedef QtPrivate::FunctionPointer<Func> FuncType;
+
+        Q_STATIC_ASSERT_X(
+            int(FuncType::ArgumentCount) == 0,
+            "The number of parameters of complete callback can only be equal to 0");
+
+        setCompleteCallback(McCppAsyncCallback::build(recever, callback));
+        return *this;
+    }
+    template<typename Func>
+    typename std::enable_if<int(QtPrivate::FunctionPointer<Func>::ArgumentCount) >= 0
+                                && !QtPrivate::FunctionPointer<Func>::IsPointerToMemberFunction,
+                            McCppResponse &>::type
+    complete(Func callback) noexcept
+    {
+        typedef QtPrivate::FunctionPointer<Func> FuncType;
+
+        Q_STATIC_ASSERT_X(
+            int(FuncType::ArgumentCount) == 0,
+            "The number of parameters of complete callback can only be equal to 0");
+
+        setCompleteCallback(McCppAsyncCallback::build(callback));
+        return *this;
+    }
+    template<typename Func>
+    typename std::enable_if<QtPrivate::FunctionPointer<Func>::ArgumentCount == -1,
+                            McCppResponse &>::type
+    complete(Func callback) noexcept
+    {
+        typedef McPrivate::LambdaType<Func> FuncType;
+
+        Q_STATIC_ASSERT_X(
+            int(FuncType::ArgumentCount) == 0,
+            "The number of parameters of complete callback can only be equal to 0");
+
+        setCompleteCallback(McCppAsyncCallback::build(callback));
+        return *this;
+    }
+
 protected:
     void callCallback() noexcept override;
     void callError() noexcept override;
+    void callChunk(const QVariant &chunk) noexcept override;
+    void callComplete() noexcept override;
+    void callFinished(bool isError) noexcept override;
 
 private:
     McCppResponse &thenImpl(bool isQVariant,
@@ -318,6 +420,8 @@ private:
                              int argumentId,
                              const QObject *recever,
                              QtPrivate::QSlotObjectBase *func) noexcept;
+    void setChunkCallback(const IMcCallbackPtr &val) noexcept;
+    void setCompleteCallback(const IMcCallbackPtr &val) noexcept;
     void call(QtPrivate::QSlotObjectBase *func) noexcept;
 
 private:
@@ -45,13 +45,18 @@ public:
     Q_INVOKABLE McQmlResponse *asyncThen(const QJSValue &callback) noexcept;
     Q_INVOKABLE McQmlResponse *error(const QJSValue &func) noexcept;
     Q_INVOKABLE McQmlResponse *progress(const QJSValue &callback) noexcept;
+    Q_INVOKABLE McQmlResponse *chunk(const QJSValue &callback) noexcept;
+    Q_INVOKABLE McQmlResponse *complete(const QJSValue &callback) noexcept;
 
 protected:
     void callCallback() noexcept override;
     void callError() noexcept override;
+    void callChunk(const QVariant &chunk) noexcept override;
+    void callComplete() noexcept override;
 
 private:
     void call(QJSValue &func) noexcept;
+    void call(QJSValue &func, const QVariant &var) noexcept;
 
 private:
     MC_DECL_PRIVATE(McQmlResponse)
@@ -29,6 +29,7 @@
 #include "../Utils/McCancel.h"
 #include "../Utils/McPause.h"
 #include "../Utils/McProgress.h"
+#include "../Utils/McStream.h"
 
 namespace Mc::QuickBoot::Private {
 
@@ -42,6 +43,7 @@ struct MCQUICKBOOT_EXPORT McRequestSharedData : public QSharedData
     McCancel cancel;
     McPause pause;
     McProgress progress;
+    McStream stream;
     QVariantList params;
 };
 
@@ -55,6 +57,7 @@ public:
     McCancel cancel() const noexcept;
     McPause pause() const noexcept;
     McProgress progress() const noexcept;
+    McStream stream() const noexcept;
 
     int count() const noexcept;
     QVariant variant(int i) const noexcept;
@@ -78,6 +81,7 @@ private:
     void setCancel(const McCancel &val) noexcept;
     void setPause(const McPause &val) noexcept;
     void setProgress(const McProgress &val) noexcept;
+    void setStream(const McStream &val) noexcept;
     void setParams(const QVariantList &val) noexcept;
     template<typename...>
     struct CheckHelper;
@@ -137,6 +141,7 @@ public:
         t.setParams(vals);
         t.setCancel(request.cancel());
         t.setProgress(request.progress());
+        t.setStream(request.stream());
         return QVariant::fromValue(t);
     }
 };
@@ -0,0 +1,336 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <QtGlobal>
+
+//! 协程需要C++20，在C++17下编译时本文件不提供任何内容
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#define MC_HAS_COROUTINE
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include <QMutex>
+#include <QPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "../Controller/impl/McCppResponse.h"
+#include "McJsonUtils.h"
+
+namespace Mc::QuickBoot {
+
+/*!
+ * \brief The McCoExecutor class
+ * 决定协程在哪里恢复执行。默认在结果送达的线程上直接恢复，
+ * 对于同步回调来说即调用invoke的线程；也可以指定一个QObject，
+ * 在它所在的线程上恢复，或者指定一个线程池
+ */
+class McCoExecutor
+{
+public:
+    McCoExecutor() noexcept = default;
+    McCoExecutor(QObject *context) noexcept : m_context(context), m_hasContext(true) {}
+    McCoExecutor(QThreadPool *pool) noexcept : m_pool(pool) {}
+
+    //! 是否在结果送达的线程上直接恢复
+    bool isInline() const noexcept { return !m_hasContext && m_pool == nullptr; }
+
+    void execute(std::coroutine_handle<> handle) const noexcept
+    {
+        if (m_pool != nullptr) {
+            m_pool->start([handle]() { handle.resume(); });
+        } else if (m_hasContext) {
+            if (m_context.isNull()) {
+                qCWarning(mcQuickBoot(), "the context of coroutine is destroyed. cannot resume");
+                return;
+            }
+            QMetaObject::invokeMethod(
+                m_context.data(), [handle]() { handle.resume(); }, Qt::QueuedConnection);
+        } else {
+            handle.resume();
+        }
+    }
+
+private:
+    QPointer<QObject> m_context;
+    bool m_hasContext{false};
+    QThreadPool *m_pool{nullptr};
+};
+
+namespace Private {
+
+template<typename T>
+T convertBody(const QVariant &body) noexcept
+{
+    if constexpr (std::is_same_v<T, QVariant>) {
+        return body;
+    } else {
+        auto id = qMetaTypeId<T>();
+        auto var = body;
+        if (var.userType() != id) {
+            var = McJsonUtils::serialize(var);
+            if (var.userType() == qMetaTypeId<QJsonObject>()) {
+                var = McJsonUtils::deserialize(var, id);
+            }
+        }
+        return var.template value<T>();
+    }
+}
+
+} // namespace Private
+
+/*!
+ * \brief The McResponseAwaiter class
+ * co_await的结果为响应体，T不为QVariant时按照then相同的规则转换。
+ * 请求出错时结果为McResultPtr，可通过isError判断。
+ * \note 必须在invoke返回后立即co_await，不要先挂接then等回调
+ */
+template<typename T = QVariant>
+class McResponseAwaiter
+{
+public:
+    McResponseAwaiter(McCppResponse &response,
+                      const McCoExecutor &executor = McCoExecutor()) noexcept
+        : m_response(&response), m_executor(executor)
+    {
+        //! 指定执行器时不需要再回到调用线程，省去一次事件循环，同时允许在没有事件循环的线程中等待
+        if (!m_executor.isInline()) {
+            m_response->setAsyncCall(true);
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        m_handle = handle;
+        m_response->addContinuation([this](const QVariant &body, bool isError) {
+            m_body = body;
+            m_isError = isError;
+            //! 如果await_suspend还没有返回，则由它负责直接恢复协程
+            if (m_isSuspended.exchange(true, std::memory_order_acq_rel)) {
+                m_executor.execute(m_handle);
+            }
+        });
+        return !m_isSuspended.exchange(true, std::memory_order_acq_rel);
+    }
+
+    T await_resume() const noexcept { return Private::convertBody<T>(m_body); }
+
+    bool isError() const noexcept { return m_isError; }
+
+private:
+    McCppResponse *m_response{nullptr};
+    McCoExecutor m_executor;
+    std::coroutine_handle<> m_handle;
+    std::atomic<bool> m_isSuspended{false};
+    QVariant m_body;
+    bool m_isError{false};
+};
+
+//! 以指定的执行器等待响应，如co_await Mc::QuickBoot::awaitResponse<int>(resp, pool)
+template<typename T = QVariant>
+McResponseAwaiter<T> awaitResponse(McCppResponse &response,
+                                   const McCoExecutor &executor = McCoExecutor()) noexcept
+{
+    return McResponseAwaiter<T>(response, executor);
+}
+
+template<typename T>
+class McTask;
+
+namespace Private {
+
+class McTaskPromiseBase
+{
+public:
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            auto &promise = handle.promise();
+            std::coroutine_handle<> continuation;
+            {
+                QMutexLocker locker(&promise.m_mtx);
+                promise.m_isDone = true;
+                continuation = promise.m_continuation;
+                promise.m_cond.wakeAll();
+            }
+            if (promise.release()) {
+                handle.destroy();
+                return std::noop_coroutine();
+            }
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    //! 立即开始执行，这样控制器中可以直接发起任务
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { std::terminate(); }
+
+    bool isDone() noexcept
+    {
+        QMutexLocker locker(&m_mtx);
+        return m_isDone;
+    }
+    void wait() noexcept
+    {
+        QMutexLocker locker(&m_mtx);
+        while (!m_isDone) {
+            m_cond.wait(&m_mtx);
+        }
+    }
+    //! 返回false表示任务已经结束，调用方应直接继续执行
+    bool setContinuation(std::coroutine_handle<> handle) noexcept
+    {
+        QMutexLocker locker(&m_mtx);
+        if (m_isDone) {
+            return false;
+        }
+        m_continuation = handle;
+        return true;
+    }
+    //! 协程帧由McTask与协程本身共同持有，最后一个释放者负责销毁
+    bool release() noexcept { return m_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+private:
+    QMutex m_mtx;
+    QWaitCondition m_cond;
+    bool m_isDone{false};
+    std::coroutine_handle<> m_continuation;
+    std::atomic<int> m_refCount{2};
+};
+
+template<typename T>
+class McTaskPromise : public McTaskPromiseBase
+{
+public:
+    McTask<T> get_return_object() noexcept;
+    void return_value(const T &val) noexcept { m_value = val; }
+    T value() const noexcept { return m_value.value_or(T()); }
+
+private:
+    std::optional<T> m_value;
+};
+
+template<>
+class McTaskPromise<void> : public McTaskPromiseBase
+{
+public:
+    McTask<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+    void value() const noexcept {}
+};
+
+} // namespace Private
+
+/*!
+ * \brief The McTask class
+ * 协程返回类型。任务创建后立即执行，可以被其他协程co_await，
+ * 也可以在控制器中调用result阻塞等待结果后直接返回。
+ * \note 在控制器所在的工作线程中等待请求结果时，需要为McResponseAwaiter指定执行器，
+ * 否则结果会被投递到没有事件循环的工作线程
+ */
+template<typename T = void>
+class McTask
+{
+public:
+    using promise_type = Private::McTaskPromise<T>;
+
+    explicit McTask(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) {}
+    McTask(McTask &&o) noexcept : m_handle(std::exchange(o.m_handle, nullptr)) {}
+    McTask &operator=(McTask &&o) noexcept
+    {
+        if (this != &o) {
+            reset();
+            m_handle = std::exchange(o.m_handle, nullptr);
+        }
+        return *this;
+    }
+    McTask(const McTask &) = delete;
+    McTask &operator=(const McTask &) = delete;
+    ~McTask() { reset(); }
+
+    bool isFinished() const noexcept { return m_handle && m_handle.promise().isDone(); }
+
+    //! 阻塞当前线程直到任务结束，不要在任务恢复所需的线程上调用
+    T result() const noexcept
+    {
+        m_handle.promise().wait();
+        return m_handle.promise().value();
+    }
+
+    bool await_ready() const noexcept { return isFinished(); }
+    bool await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        return m_handle.promise().setContinuation(handle);
+    }
+    T await_resume() const noexcept { return m_handle.promise().value(); }
+
+private:
+    void reset() noexcept
+    {
+        if (m_handle && m_handle.promise().release()) {
+            m_handle.destroy();
+        }
+        m_handle = nullptr;
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace Private {
+
+template<typename T>
+McTask<T> McTaskPromise<T>::get_return_object() noexcept
+{
+    return McTask<T>(std::coroutine_handle<McTaskPromise<T>>::from_promise(*this));
+}
+
+inline McTask<void> McTaskPromise<void>::get_return_object() noexcept
+{
+    return McTask<void>(std::coroutine_handle<McTaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace Private
+
+} // namespace Mc::QuickBoot
+
+inline Mc::QuickBoot::McResponseAwaiter<QVariant> operator co_await(McCppResponse &response) noexcept
+{
+    return Mc::QuickBoot::McResponseAwaiter<QVariant>(response);
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <QFuture>
+#include <QPointer>
+#include <QVariant>
+
+#include "../McBootMacroGlobal.h"
+
+class McCppResponse;
+
+struct McWhenAnyResult
+{
+    int index{-1}; //!< 最先结束的请求在传入列表中的下标
+    QVariant body;
+    bool isError{false};
+};
+
+Q_DECLARE_METATYPE(McWhenAnyResult)
+
+namespace Mc::QuickBoot {
+
+/*!
+ * 以下组合函数均挂接在McCppResponse的续体上，不轮询也不占用额外线程。
+ * 出错的请求其结果为McResultPtr，已析构或在结果送达前析构的请求按出错处理
+ */
+//! 所有请求结束后完成，结果顺序与传入顺序一致
+MCQUICKBOOT_EXPORT QFuture<QVariantList> whenAll(
+    const QList<QPointer<McCppResponse>> &responses) noexcept;
+//! 任意一个请求结束后完成
+MCQUICKBOOT_EXPORT QFuture<McWhenAnyResult> whenAny(
+    const QList<QPointer<McCppResponse>> &responses) noexcept;
+
+} // namespace Mc::QuickBoot
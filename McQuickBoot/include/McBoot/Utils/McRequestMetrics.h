@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <atomic>
+
+#include <QJsonObject>
+
+#include "../McBootGlobal.h"
+
+/*!
+ * \brief The McLatencyHistogram class
+ * HDR风格的对数线性直方图，单位为微秒。每个2的幂区间再细分为16个桶，
+ * 相对误差不超过1/16。记录时只做原子自增，不加锁
+ */
+class MCQUICKBOOT_EXPORT McLatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 4;
+    static constexpr int SubBucketCount = 1 << SubBucketBits;
+    static constexpr int BucketCount = 40 * SubBucketCount;
+
+    McLatencyHistogram() noexcept;
+
+    void record(qint64 nsecs) noexcept;
+    void reset() noexcept;
+
+    quint64 count() const noexcept;
+    //! 返回对应百分位所在桶的上界，单位：微秒
+    qint64 percentile(double p) const noexcept;
+    QJsonObject toJson() const noexcept;
+
+private:
+    static int bucketIndex(quint64 usecs) noexcept;
+    static qint64 bucketUpperBound(int index) noexcept;
+
+private:
+    std::atomic<quint64> m_buckets[BucketCount];
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sum{0};
+    std::atomic<quint64> m_max{0};
+};
+
+struct MCQUICKBOOT_EXPORT McRouteMetrics
+{
+    QString route;
+    std::atomic<quint64> count{0};
+    std::atomic<quint64> errorCount{0};
+    McLatencyHistogram queue;    //!< 从发起请求到在线程池中开始执行
+    McLatencyHistogram exec;     //!< 控制器执行耗时
+    McLatencyHistogram delivery; //!< 从得到结果到回调执行完毕
+
+    void reset() noexcept;
+    QJsonObject toJson() const noexcept;
+};
+
+/*!
+ * \brief The McRequestMetrics class
+ * 按路由(controller.method)统计请求次数、错误次数与各阶段耗时。
+ * 路由表为定长开放寻址表，查找与插入均为无锁操作。默认关闭
+ */
+class MCQUICKBOOT_EXPORT McRequestMetrics
+{
+    MC_DECL_INIT(McRequestMetrics)
+public:
+    static bool isEnabled() noexcept;
+    static void setEnabled(bool val) noexcept;
+    //! 程序退出时将统计结果写入此文件，为空则不写入
+    static void setDumpPath(const QString &path) noexcept;
+
+    //! 单调时钟，单位：纳秒
+    static qint64 now() noexcept;
+    //! uri中?之后的参数部分不参与统计。只应传入已注册的路由，路由表满后统计到otherRoute中
+    static McRouteMetrics *route(const QString &uri) noexcept;
+    //! 未注册的路由和路由表溢出时共用的统计项
+    static McRouteMetrics *otherRoute() noexcept;
+
+    static QJsonObject snapshot() noexcept;
+    static void reset() noexcept;
+    static bool dump(const QString &path) noexcept;
+};
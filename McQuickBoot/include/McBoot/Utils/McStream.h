@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#pragma once
+
+#include <functional>
+
+#include <QMutex>
+#include <QRecursiveMutex>
+#include <QObject>
+#include <QSharedData>
+#include <QWaitCondition>
+
+#include <McIoc/McGlobal.h>
+
+#include "../McBootMacroGlobal.h"
+
+struct MCQUICKBOOT_EXPORT McStreamSharedData : public QSharedData
+{
+    QAtomicInteger<bool> isClosed{false};
+    QAtomicInteger<bool> isAborted{false};
+    int capacity{16}; //!< 尚未被接收端消费的最大块数，超过时write将阻塞
+    int pending{0};
+    QMutex mtx;
+    QWaitCondition cond;
+    //! 保护sink和completer，接收端析构时在此锁内解除绑定，之后不会再调用接收端。
+    //! 递归锁允许接收端在回调中析构
+    QRecursiveMutex sinkMtx;
+    std::function<bool(const QVariant &)> sink;
+    std::function<void()> completer;
+};
+
+/*!
+ * \brief The McStream class
+ * 控制器通过McRequest::stream()获取此对象，每产生一块数据就调用write推送给请求方，
+ * 全部数据推送完毕后调用close。接收端未及时消费时write会阻塞，以此实现背压。
+ */
+class MCQUICKBOOT_EXPORT McStream
+{
+    MC_DECL_INIT(McStream)
+public:
+    McStream() noexcept;
+    ~McStream();
+
+    int capacity() const noexcept;
+    void setCapacity(int val) noexcept;
+
+    bool isClosed() const noexcept;
+    bool isAborted() const noexcept;
+
+    //! 推送一块数据，请求已取消或接收端已析构时返回false
+    bool write(const QVariant &chunk) noexcept;
+    template<typename T>
+    bool write(const T &chunk) noexcept
+    {
+        return write(QVariant::fromValue(chunk));
+    }
+    void close() noexcept;
+
+private:
+    void abort() noexcept;
+    void release() noexcept;
+    void setSink(const std::function<bool(const QVariant &)> &sink,
+                 const std::function<void()> &completer) noexcept;
+    //! 接收端析构时调用，返回后write和close不会再访问接收端
+    void detach() noexcept;
+
+private:
+    QExplicitlySharedDataPointer<McStreamSharedData> d;
+
+    friend class McAbstractResponse;
+};
+
+Q_DECLARE_METATYPE(McStream)
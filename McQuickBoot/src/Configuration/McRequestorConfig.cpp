@@ -34,6 +34,8 @@ int maxThreadCount{QThread::idealThreadCount()};
 bool autoIncrease{true};
 bool waitThreadPoolDone{true};
 int threadPoolWaitTimeout{-1};
+bool metricsEnabled{false}; //!< 开启后每个请求都会读取时钟并查找路由表
+QString metricsDumpPath; //!< 为空则退出时不输出统计数据
 MC_DECL_PRIVATE_DATA_END
 
 McRequestorConfig::McRequestorConfig(QObject *parent) noexcept : QObject(parent)
@@ -82,3 +84,23 @@ void McRequestorConfig::setThreadPoolWaitTimeout(int val) noexcept
 {
     d->threadPoolWaitTimeout = val;
 }
+
+bool McRequestorConfig::metricsEnabled() const noexcept
+{
+    return d->metricsEnabled;
+}
+
+void McRequestorConfig::setMetricsEnabled(bool val) noexcept
+{
+    d->metricsEnabled = val;
+}
+
+QString McRequestorConfig::metricsDumpPath() const noexcept
+{
+    return d->metricsDumpPath;
+}
+
+void McRequestorConfig::setMetricsDumpPath(const QString &val) noexcept
+{
+    d->metricsDumpPath = val;
+}
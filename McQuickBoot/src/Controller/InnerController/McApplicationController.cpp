@@ -26,6 +26,8 @@
 #include <QCoreApplication>
 #include <QDebug>
 
+#include "McBoot/Utils/McRequestMetrics.h"
+
 MC_DECL_PRIVATE_DATA(McApplicationController)
 MC_DECL_PRIVATE_DATA_END
 
@@ -50,3 +52,13 @@ QString McApplicationController::filePath() const noexcept
 {
     return Mc::applicationFilePath();
 }
+
+QJsonObject McApplicationController::metrics() const noexcept
+{
+    return McRequestMetrics::snapshot();
+}
+
+void McApplicationController::resetMetrics() noexcept
+{
+    McRequestMetrics::reset();
+}
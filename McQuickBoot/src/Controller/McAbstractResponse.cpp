@@ -26,24 +26,31 @@
 #include <QCoreApplication>
 #include <QEvent>
 #include <QPointer>
+#include <QThread>
 #include <QVariant>
 
 #include <McIoc/Utils/McScopedFunction.h>
+#include <McIoc/Utils/McWaitNotifier.h>
 
 #include "McBoot/Controller/impl/McResult.h"
+#include "McBoot/Utils/McRequestMetrics.h"
 #include "McBoot/Utils/Response/IMcResponseHandler.h"
 
 MC_DECL_PRIVATE_DATA(McAbstractResponse)
-bool isAsyncCall{false}; //! 是否在次线程调用callback，默认不需要
+QAtomicInteger<bool> isAsyncCall{false}; //! 是否在次线程调用callback，默认不需要
 McCancel cancel;
 McPause pause;
 McProgress progress;
+McStream stream;
 QVariant body;
 QPointer<QObject> attachedObject;
 bool isAttached{false};
 QList<IMcResponseHandlerPtr> responseHanlders;
 QAtomicInteger<bool> isStarted{false};
 QAtomicInteger<bool> isFinished{false};
+McWaitNotifierPtr finishedNotifier{McWaitNotifierPtr::create()};
+McRouteMetrics *metrics{nullptr};
+qint64 bodyTime{0};
 MC_DECL_PRIVATE_DATA_END
 
 MC_INIT(McAbstractResponse)
@@ -52,9 +59,19 @@ MC_INIT_END
 McAbstractResponse::McAbstractResponse(QObject *parent) : QObject(parent)
 {
     MC_NEW_PRIVATE_DATA(McAbstractResponse);
+
+    //! 回调只通过流的共享状态调用，析构时在sinkMtx内解除绑定，
+    //! 控制器线程不会在本对象析构期间或之后访问this
+    d->stream.setSink([this](const QVariant &chunk) { return postChunk(chunk); },
+                      [this]() { postComplete(); });
 }
 
-McAbstractResponse::~McAbstractResponse() {}
+McAbstractResponse::~McAbstractResponse()
+{
+    //! 唤醒可能因背压而阻塞的控制器线程
+    d->stream.abort();
+    d->stream.detach();
+}
 
 void McAbstractResponse::setHandlers(const QList<IMcResponseHandlerPtr> &val) noexcept
 {
@@ -64,6 +81,7 @@ void McAbstractResponse::setHandlers(const QList<IMcResponseHandlerPtr> &val) no
 void McAbstractResponse::cancel() noexcept
 {
     d->cancel.cancel();
+    d->stream.abort();
 }
 
 bool McAbstractResponse::isCanceled() const noexcept
@@ -103,17 +121,21 @@ QVariant McAbstractResponse::result() const noexcept
 
 bool McAbstractResponse::waitForFinished(qint64 msec) const noexcept
 {
-    return Mc::waitForExecFunc([this]() { return this->isFinished(); }, msec);
+    //! 结果需要投递到本对象所在线程时，等待期间必须继续处理本线程的事件
+    auto processEvents = QThread::currentThread() == thread();
+    //! 持有通知器的副本，结束后本对象会被deleteLater，等待返回后不能再访问this
+    auto notifier = d->finishedNotifier;
+    return notifier->wait(msec, processEvents);
 }
 
 bool McAbstractResponse::isAsyncCall() const noexcept
 {
-    return d->isAsyncCall;
+    return d->isAsyncCall.loadAcquire();
 }
 
 void McAbstractResponse::setAsyncCall(bool val) noexcept
 {
-    d->isAsyncCall = val;
+    d->isAsyncCall.storeRelease(val);
 }
 
 void McAbstractResponse::attach(QObject *obj) noexcept
@@ -132,6 +154,12 @@ void McAbstractResponse::customEvent(QEvent *event)
 {
     if (event->type() == QEvent::Type::User + 1) {
         call();
+    } else if (event->type() == QEvent::Type::User + 2) {
+        auto e = static_cast<McCustomEvent *>(event);
+        callChunk(e->data());
+        d->stream.release();
+    } else if (event->type() == QEvent::Type::User + 3) {
+        callComplete();
     }
 }
 
@@ -153,6 +181,11 @@ void McAbstractResponse::setBody(const QVariant &var) noexcept
     qApp->postEvent(this, new QEvent(static_cast<QEvent::Type>(QEvent::Type::User + 1)));
 }
 
+void McAbstractResponse::callFinished(bool isError) noexcept
+{
+    Q_UNUSED(isError)
+}
+
 void McAbstractResponse::setStarted(bool val) noexcept
 {
     d->isStarted.storeRelaxed(val);
@@ -161,6 +194,11 @@ void McAbstractResponse::setStarted(bool val) noexcept
 void McAbstractResponse::setFinished(bool val) noexcept
 {
     d->isFinished.storeRelaxed(val);
+    if (val) {
+        d->finishedNotifier->notify();
+    } else {
+        d->finishedNotifier->reset();
+    }
 }
 
 McProgress &McAbstractResponse::getProgress() const noexcept
@@ -178,10 +216,22 @@ McPause &McAbstractResponse::getPause() const noexcept
     return d->pause;
 }
 
+McStream &McAbstractResponse::getStream() const noexcept
+{
+    return d->stream;
+}
+
 void McAbstractResponse::call() noexcept
 {
     McScopedFunction cleanup([this]() {
+        if (d->metrics != nullptr) {
+            d->metrics->delivery.record(McRequestMetrics::now() - d->bodyTime);
+            if (this->isInternalError()) {
+                d->metrics->errorCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
         this->setFinished();
+        this->callFinished(this->isInternalError());
         this->deleteLater();
     });
     Q_UNUSED(cleanup)
@@ -200,11 +250,52 @@ void McAbstractResponse::call() noexcept
         callCallback();
         return;
     }
-    auto result = d->body.value<McResultPtr>();
-    if (result->isInternalError()) {
-        qCWarning(mcQuickBoot()) << result;
+    if (isInternalError()) {
+        qCWarning(mcQuickBoot()) << d->body.value<McResultPtr>();
         callError();
     } else {
         callCallback();
     }
 }
+
+bool McAbstractResponse::postChunk(const QVariant &chunk) noexcept
+{
+    if (isFinished()) {
+        return false;
+    }
+    if (isAsyncCall()) {
+        callChunk(chunk);
+        d->stream.release();
+        return true;
+    }
+    //! 与setBody使用同一事件队列，保证所有数据块都先于最终结果到达
+    qApp->postEvent(this, new McCustomEvent(QEvent::Type::User + 2, chunk));
+    return true;
+}
+
+void McAbstractResponse::postComplete() noexcept
+{
+    if (isFinished()) {
+        return;
+    }
+    if (isAsyncCall()) {
+        callComplete();
+        return;
+    }
+    qApp->postEvent(this, new QEvent(static_cast<QEvent::Type>(QEvent::Type::User + 3)));
+}
+
+bool McAbstractResponse::isInternalError() const noexcept
+{
+    if (!d->body.canConvert<McResultPtr>()) {
+        return false;
+    }
+    auto result = d->body.value<McResultPtr>();
+    return !result.isNull() && result->isInternalError();
+}
+
+void McAbstractResponse::setMetrics(McRouteMetrics *metrics, qint64 bodyTime) noexcept
+{
+    d->metrics = metrics;
+    d->bodyTime = bodyTime;
+}
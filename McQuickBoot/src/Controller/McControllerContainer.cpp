@@ -171,6 +171,31 @@ QVariant McControllerContainer::invoke(const QString &uri,
     return ret;
 }
 
+bool McControllerContainer::hasRoute(const QString &uri) const noexcept
+{
+    QStringView path(uri);
+    auto index = path.indexOf(QLatin1Char('?'));
+    if (index != -1) {
+        path = path.left(index);
+    }
+    index = path.indexOf(QLatin1Char('.'));
+    if (index <= 0 || index == path.size() - 1) {
+        return false;
+    }
+    auto bean = d->controllers.value(path.left(index).toString());
+    if (bean.isNull()) {
+        return false;
+    }
+    auto func = path.mid(index + 1).toLatin1();
+    const QMetaObject *metaBean = bean->metaObject();
+    for (int i = 0; i < metaBean->methodCount(); ++i) {
+        if (metaBean->method(i).name() == func) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool McControllerContainer::splitBeanAndFunc(const QString &uri,
                                              QObjectPtr &bean,
                                              QString &func,
@@ -23,6 +23,8 @@
  */
 #include "McBoot/Controller/impl/McCppResponse.h"
 
+#include <QFutureInterface>
+#include <QMutex>
 #include <QVariant>
 
 #include <McIoc/Utils/McScopedFunction.h>
@@ -36,6 +38,12 @@ int argumentId{-1};
 const QObject *recever{nullptr};
 QtPrivate::QSlotObjectBase *callback{nullptr};
 QtPrivate::QSlotObjectBase *error{nullptr};
+IMcCallbackPtr chunkCallback;
+IMcCallbackPtr completeCallback;
+QMutex continuationMtx;
+bool isCallFinished{false};
+bool isError{false};
+QList<McCppResponse::Continuation> continuations;
 MC_DECL_PRIVATE_DATA_END
 
 MC_INIT(McCppResponse)
@@ -48,6 +56,24 @@ McCppResponse::McCppResponse(QObject *parent) : McAbstractResponse(parent)
 
 McCppResponse::~McCppResponse()
 {
+    //! 结果送达前就被析构时以失败结果结束所有续体，否则whenAll、协程等等待者会永远挂起
+    QList<Continuation> continuations;
+    {
+        QMutexLocker locker(&d->continuationMtx);
+        if (!d->isCallFinished) {
+            d->isCallFinished = true;
+            d->isError = true;
+            continuations.swap(d->continuations);
+        }
+    }
+    if (!continuations.isEmpty()) {
+        auto body = QVariant::fromValue(
+            McResult::fail(QStringLiteral("the response is destroyed before it finished")));
+        for (const auto &func : qAsConst(continuations)) {
+            func(body, true);
+        }
+    }
+
     if (d->callback == nullptr) {
         return;
     }
@@ -61,6 +87,32 @@ QPointer<McCppResponse> McCppResponse::capture()
     return p;
 }
 
+void McCppResponse::addContinuation(const Continuation &func) noexcept
+{
+    if (!func) {
+        return;
+    }
+    QMutexLocker locker(&d->continuationMtx);
+    if (!d->isCallFinished) {
+        d->continuations.append(func);
+        return;
+    }
+    locker.unlock();
+    func(body(), d->isError);
+}
+
+QFuture<QVariant> McCppResponse::future() noexcept
+{
+    QFutureInterface<QVariant> promise;
+    promise.reportStarted();
+    auto future = promise.future();
+    addContinuation([promise](const QVariant &body, bool) mutable {
+        promise.reportResult(body);
+        promise.reportFinished();
+    });
+    return future;
+}
+
 void McCppResponse::callCallback() noexcept
 {
     call(d->callback);
@@ -71,6 +123,22 @@ void McCppResponse::callError() noexcept
     call(d->error);
 }
 
+void McCppResponse::callChunk(const QVariant &chunk) noexcept
+{
+    if (d->chunkCallback.isNull()) {
+        return;
+    }
+    d->chunkCallback->call(chunk);
+}
+
+void McCppResponse::callComplete() noexcept
+{
+    if (d->completeCallback.isNull()) {
+        return;
+    }
+    d->completeCallback->call(QVariantList());
+}
+
 McCppResponse &McCppResponse::thenImpl(bool isQVariant,
                                        int argumentId,
                                        const QObject *recever,
@@ -118,6 +186,31 @@ McCppResponse &McCppResponse::errorImpl(bool isQVariant,
     return *this;
 }
 
+void McCppResponse::callFinished(bool isError) noexcept
+{
+    QList<Continuation> continuations;
+    {
+        QMutexLocker locker(&d->continuationMtx);
+        d->isCallFinished = true;
+        d->isError = isError;
+        continuations.swap(d->continuations);
+    }
+    auto body = this->body();
+    for (const auto &func : qAsConst(continuations)) {
+        func(body, isError);
+    }
+}
+
+void McCppResponse::setChunkCallback(const IMcCallbackPtr &val) noexcept
+{
+    d->chunkCallback = val;
+}
+
+void McCppResponse::setCompleteCallback(const IMcCallbackPtr &val) noexcept
+{
+    d->completeCallback = val;
+}
+
 void McCppResponse::call(QtPrivate::QSlotObjectBase *func) noexcept
 {
     if (func == nullptr) {
@@ -36,6 +36,8 @@
 MC_DECL_PRIVATE_DATA(McQmlResponse)
 QJSValue callback;
 QJSValue error;
+QJSValue chunk;
+QJSValue complete;
 MC_DECL_PRIVATE_DATA_END
 
 MC_INIT(McQmlResponse)
@@ -88,6 +90,18 @@ McQmlResponse *McQmlResponse::progress(const QJSValue &callback) noexcept
     return this;
 }
 
+McQmlResponse *McQmlResponse::chunk(const QJSValue &callback) noexcept
+{
+    d->chunk = callback;
+    return this;
+}
+
+McQmlResponse *McQmlResponse::complete(const QJSValue &callback) noexcept
+{
+    d->complete = callback;
+    return this;
+}
+
 void McQmlResponse::callCallback() noexcept 
 {
     call(d->callback);
@@ -98,7 +112,25 @@ void McQmlResponse::callError() noexcept
     call(d->error);
 }
 
+void McQmlResponse::callChunk(const QVariant &chunk) noexcept
+{
+    call(d->chunk, chunk);
+}
+
+void McQmlResponse::callComplete() noexcept
+{
+    if (!d->complete.isCallable()) {
+        return;
+    }
+    d->complete.call();
+}
+
 void McQmlResponse::call(QJSValue &func) noexcept
+{
+    call(func, this->body());
+}
+
+void McQmlResponse::call(QJSValue &func, const QVariant &var) noexcept
 {
     if (!func.isCallable()) {
         return;
@@ -111,7 +143,7 @@ void McQmlResponse::call(QJSValue &func) noexcept
     if (!engine) {
         return;
     }
-    auto body = McJsonUtils::serialize(this->body());
+    auto body = McJsonUtils::serialize(var);
     auto arg = engine->toScriptValue(body);
     func.call(QJSValueList() << arg);
 }
@@ -31,17 +31,23 @@
 #include "McBoot/Controller/IMcControllerContainer.h"
 #include "McBoot/Controller/impl/McAbstractResponse.h"
 #include "McBoot/Requestor/McRequest.h"
+#include "McBoot/Utils/McRequestMetrics.h"
 
 MC_DECL_PRIVATE_DATA(McRequestRunner)
 QPointer<McAbstractResponse> response;
 IMcControllerContainerPtr controllerContainer;
 QString uri;
 QVariant body;
+qint64 enqueueTime{0}; //!< 未开启统计时为0，不读取时钟
 MC_DECL_PRIVATE_DATA_END
 
 McRequestRunner::McRequestRunner()
 {
     MC_NEW_PRIVATE_DATA(McRequestRunner)
+
+    if (McRequestMetrics::isEnabled()) {
+        d->enqueueTime = McRequestMetrics::now();
+    }
 }
 
 McRequestRunner::~McRequestRunner() 
@@ -77,11 +83,28 @@ void McRequestRunner::run()
         req.setCancel(d->response->getCancel());
         req.setPause(d->response->getPause());
         req.setProgress(d->response->getProgress());
+        req.setStream(d->response->getStream());
+    }
+    McRouteMetrics *metrics = nullptr;
+    qint64 startTime = 0;
+    if (d->enqueueTime != 0 && McRequestMetrics::isEnabled()) {
+        //! 只有已注册的路由才占用路由表，任意的uri都统计到同一项中
+        metrics = d->controllerContainer->hasRoute(d->uri) ? McRequestMetrics::route(d->uri)
+                                                           : McRequestMetrics::otherRoute();
+        startTime = McRequestMetrics::now();
+        metrics->queue.record(startTime - d->enqueueTime);
     }
     auto body = d->controllerContainer->invoke(d->uri, d->body, req);
+    if (metrics != nullptr) {
+        metrics->exec.record(McRequestMetrics::now() - startTime);
+        metrics->count.fetch_add(1, std::memory_order_relaxed);
+    }
     if(d->response.isNull()) {  //!< Response可能被QML析构
         qCritical() << "response is null. it's maybe destroyed of qmlengine";
         return;
     }
+    if (metrics != nullptr) {
+        d->response->setMetrics(metrics, McRequestMetrics::now());
+    }
     d->response->setBody(body);
 }
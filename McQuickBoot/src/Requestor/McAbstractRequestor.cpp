@@ -42,6 +42,7 @@
 #include "McBoot/Controller/impl/McAbstractResponse.h"
 #include "McBoot/Controller/impl/McRequestRunner.h"
 #include "McBoot/Model/IMcModelContainer.h"
+#include "McBoot/Utils/McRequestMetrics.h"
 #include "McBoot/Utils/Response/IMcResponseHandler.h"
 #include "McBoot/Utils/Response/McResponseHandlerFactory.h"
 
@@ -243,6 +244,8 @@ void McAbstractRequestor::allFinished() noexcept
         maxThreadCount = d->requestorConfig->maxThreadCount();
         staticData->waitThreadPoolDone = d->requestorConfig->waitThreadPoolDone();
         staticData->threadPoolWaitTimeout = d->requestorConfig->threadPoolWaitTimeout();
+        McRequestMetrics::setEnabled(d->requestorConfig->metricsEnabled());
+        McRequestMetrics::setDumpPath(d->requestorConfig->metricsDumpPath());
     }
     setMaxThreadCount(maxThreadCount);
     d->responseHanlders.append(McResponseHandlerFactory::getHandlers());
@@ -49,6 +49,11 @@ McProgress McRequest::progress() const noexcept
     return d->progress;
 }
 
+McStream McRequest::stream() const noexcept
+{
+    return d->stream;
+}
+
 int McRequest::count() const noexcept
 {
     return d->params.size();
@@ -77,6 +82,11 @@ void McRequest::setProgress(const McProgress &val) noexcept
     d->progress = val;
 }
 
+void McRequest::setStream(const McStream &val) noexcept
+{
+    d->stream = val;
+}
+
 void McRequest::setParams(const QVariantList &val) noexcept
 {
     d->params = val;
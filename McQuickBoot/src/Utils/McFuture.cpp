@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McBoot/Utils/McFuture.h"
+
+#include <QFutureInterface>
+#include <QMutex>
+
+#include "McBoot/Controller/impl/McCppResponse.h"
+#include "McBoot/Controller/impl/McResult.h"
+
+MC_STATIC()
+qRegisterMetaType<McWhenAnyResult>();
+MC_STATIC_END
+
+namespace {
+
+//! 请求已析构时立即以失败结果调用func
+void addContinuation(const QPointer<McCppResponse> &response,
+                     const McCppResponse::Continuation &func) noexcept
+{
+    if (response.isNull()) {
+        func(QVariant::fromValue(McResult::fail(QStringLiteral("the response is destroyed"))), true);
+        return;
+    }
+    response->addContinuation(func);
+}
+
+} // namespace
+
+namespace Mc::QuickBoot {
+
+QFuture<QVariantList> whenAll(const QList<QPointer<McCppResponse>> &responses) noexcept
+{
+    struct WhenAllState
+    {
+        QMutex mtx;
+        QVariantList results;
+        int remaining{0};
+        QFutureInterface<QVariantList> promise;
+    };
+    auto state = QSharedPointer<WhenAllState>::create();
+    state->promise.reportStarted();
+    auto future = state->promise.future();
+    if (responses.isEmpty()) {
+        state->promise.reportResult(QVariantList());
+        state->promise.reportFinished();
+        return future;
+    }
+    state->remaining = responses.size();
+    for (int i = 0; i < responses.size(); ++i) {
+        state->results.append(QVariant());
+    }
+    for (int i = 0; i < responses.size(); ++i) {
+        addContinuation(responses.at(i), [state, i](const QVariant &body, bool) {
+            QMutexLocker locker(&state->mtx);
+            state->results[i] = body;
+            if (--state->remaining != 0) {
+                return;
+            }
+            state->promise.reportResult(state->results);
+            state->promise.reportFinished();
+        });
+    }
+    return future;
+}
+
+QFuture<McWhenAnyResult> whenAny(const QList<QPointer<McCppResponse>> &responses) noexcept
+{
+    struct WhenAnyState
+    {
+        QAtomicInteger<bool> isDone{false};
+        QFutureInterface<McWhenAnyResult> promise;
+    };
+    auto state = QSharedPointer<WhenAnyState>::create();
+    state->promise.reportStarted();
+    auto future = state->promise.future();
+    if (responses.isEmpty()) {
+        state->promise.reportResult(McWhenAnyResult());
+        state->promise.reportFinished();
+        return future;
+    }
+    for (int i = 0; i < responses.size(); ++i) {
+        addContinuation(responses.at(i), [state, i](const QVariant &body, bool isError) {
+            if (!state->isDone.testAndSetOrdered(false, true)) {
+                return;
+            }
+            McWhenAnyResult result;
+            result.index = i;
+            result.body = body;
+            result.isError = isError;
+            state->promise.reportResult(result);
+            state->promise.reportFinished();
+        });
+    }
+    return future;
+}
+
+} // namespace Mc::QuickBoot
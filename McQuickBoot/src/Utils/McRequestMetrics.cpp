@@ -0,0 +1,272 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McBoot/Utils/McRequestMetrics.h"
+
+#include <chrono>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace {
+
+constexpr int RouteTableSize = 1024;
+
+}
+
+MC_GLOBAL_STATIC_BEGIN(metricsStaticData)
+std::atomic<bool> isEnabled{false};
+QString dumpPath;
+std::atomic<McRouteMetrics *> routes[RouteTableSize]{};
+McRouteMetrics overflow;
+MC_GLOBAL_STATIC_END(metricsStaticData)
+
+MC_INIT(McRequestMetrics)
+metricsStaticData->overflow.route = QStringLiteral("<other>");
+MC_DESTROY()
+if (!metricsStaticData.exists() || metricsStaticData->dumpPath.isEmpty()) {
+    return;
+}
+McRequestMetrics::dump(metricsStaticData->dumpPath);
+MC_INIT_END
+
+McLatencyHistogram::McLatencyHistogram() noexcept
+{
+    for (auto &bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void McLatencyHistogram::record(qint64 nsecs) noexcept
+{
+    quint64 usecs = nsecs <= 0 ? 0 : static_cast<quint64>(nsecs) / 1000;
+    m_buckets[bucketIndex(usecs)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(usecs, std::memory_order_relaxed);
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (usecs > max && !m_max.compare_exchange_weak(max, usecs, std::memory_order_relaxed)) {
+    }
+}
+
+void McLatencyHistogram::reset() noexcept
+{
+    for (auto &bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+quint64 McLatencyHistogram::count() const noexcept
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+qint64 McLatencyHistogram::percentile(double p) const noexcept
+{
+    quint64 total = 0;
+    quint64 counts[BucketCount];
+    for (int i = 0; i < BucketCount; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    auto rank = static_cast<quint64>(qBound(0.0, p, 100.0) / 100.0 * total + 0.5);
+    rank = qBound<quint64>(1, rank, total);
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return qMin<qint64>(bucketUpperBound(i), m_max.load(std::memory_order_relaxed));
+        }
+    }
+    return m_max.load(std::memory_order_relaxed);
+}
+
+QJsonObject McLatencyHistogram::toJson() const noexcept
+{
+    QJsonObject obj;
+    auto c = count();
+    obj.insert("count", static_cast<qint64>(c));
+    obj.insert("mean", c == 0 ? 0 : static_cast<qint64>(m_sum.load(std::memory_order_relaxed) / c));
+    obj.insert("p50", percentile(50));
+    obj.insert("p90", percentile(90));
+    obj.insert("p99", percentile(99));
+    obj.insert("p999", percentile(99.9));
+    obj.insert("max", static_cast<qint64>(m_max.load(std::memory_order_relaxed)));
+    return obj;
+}
+
+int McLatencyHistogram::bucketIndex(quint64 usecs) noexcept
+{
+    if (usecs < SubBucketCount) {
+        return static_cast<int>(usecs);
+    }
+    int msb = 63 - qCountLeadingZeroBits(usecs);
+    int shift = msb - SubBucketBits;
+    int sub = static_cast<int>((usecs >> shift) & (SubBucketCount - 1));
+    return qMin((shift + 1) * SubBucketCount + sub, BucketCount - 1);
+}
+
+qint64 McLatencyHistogram::bucketUpperBound(int index) noexcept
+{
+    if (index < SubBucketCount) {
+        return index;
+    }
+    int shift = index / SubBucketCount - 1;
+    int sub = index % SubBucketCount;
+    qint64 lower = static_cast<qint64>(SubBucketCount + sub) << shift;
+    return lower + (qint64(1) << shift) - 1;
+}
+
+void McRouteMetrics::reset() noexcept
+{
+    count.store(0, std::memory_order_relaxed);
+    errorCount.store(0, std::memory_order_relaxed);
+    queue.reset();
+    exec.reset();
+    delivery.reset();
+}
+
+QJsonObject McRouteMetrics::toJson() const noexcept
+{
+    QJsonObject obj;
+    obj.insert("route", route);
+    obj.insert("count", static_cast<qint64>(count.load(std::memory_order_relaxed)));
+    obj.insert("errorCount", static_cast<qint64>(errorCount.load(std::memory_order_relaxed)));
+    obj.insert("queue", queue.toJson());
+    obj.insert("exec", exec.toJson());
+    obj.insert("delivery", delivery.toJson());
+    return obj;
+}
+
+bool McRequestMetrics::isEnabled() noexcept
+{
+    return metricsStaticData->isEnabled.load(std::memory_order_relaxed);
+}
+
+void McRequestMetrics::setEnabled(bool val) noexcept
+{
+    metricsStaticData->isEnabled.store(val, std::memory_order_relaxed);
+}
+
+void McRequestMetrics::setDumpPath(const QString &path) noexcept
+{
+    metricsStaticData->dumpPath = path;
+}
+
+qint64 McRequestMetrics::now() noexcept
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+McRouteMetrics *McRequestMetrics::route(const QString &uri) noexcept
+{
+    //! 只在插入新路由时才分配字符串，查找时直接对视图取哈希和比较
+    QStringView name(uri);
+    auto index = name.indexOf(QLatin1Char('?'));
+    if (index != -1) {
+        name = name.left(index);
+    }
+    auto &routes = metricsStaticData->routes;
+    auto hash = qHash(name);
+    McRouteMetrics *created = nullptr;
+    for (int i = 0; i < RouteTableSize; ++i) {
+        auto &slot = routes[(hash + i) % RouteTableSize];
+        auto current = slot.load(std::memory_order_acquire);
+        if (current == nullptr) {
+            if (created == nullptr) {
+                created = new McRouteMetrics();
+                created->route = name.toString();
+            }
+            if (slot.compare_exchange_strong(current,
+                                             created,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+                return created;
+            }
+        }
+        //! 其他线程抢先插入了该槽位，current为其插入的值
+        if (QStringView(current->route) == name) {
+            delete created;
+            return current;
+        }
+    }
+    delete created;
+    return &metricsStaticData->overflow;
+}
+
+McRouteMetrics *McRequestMetrics::otherRoute() noexcept
+{
+    return &metricsStaticData->overflow;
+}
+
+QJsonObject McRequestMetrics::snapshot() noexcept
+{
+    QJsonArray routes;
+    for (auto &slot : metricsStaticData->routes) {
+        auto route = slot.load(std::memory_order_acquire);
+        if (route != nullptr) {
+            routes.append(route->toJson());
+        }
+    }
+    if (metricsStaticData->overflow.count.load(std::memory_order_relaxed) != 0) {
+        routes.append(metricsStaticData->overflow.toJson());
+    }
+    QJsonObject obj;
+    obj.insert("enabled", isEnabled());
+    obj.insert("unit", "us");
+    obj.insert("routes", routes);
+    return obj;
+}
+
+void McRequestMetrics::reset() noexcept
+{
+    for (auto &slot : metricsStaticData->routes) {
+        auto route = slot.load(std::memory_order_acquire);
+        if (route != nullptr) {
+            route->reset();
+        }
+    }
+    metricsStaticData->overflow.reset();
+}
+
+bool McRequestMetrics::dump(const QString &path) noexcept
+{
+    auto filePath = Mc::toAbsolutePath(path);
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(mcQuickBoot(), "cannot open metrics file: %s", qPrintable(filePath));
+        return false;
+    }
+    file.write(QJsonDocument(snapshot()).toJson());
+    return true;
+}
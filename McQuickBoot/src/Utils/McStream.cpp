@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "McBoot/Utils/McStream.h"
+
+MC_INIT(McStream)
+qRegisterMetaType<McStream>();
+MC_INIT_END
+
+McStream::McStream() noexcept
+{
+    d = new McStreamSharedData();
+}
+
+McStream::~McStream() {}
+
+int McStream::capacity() const noexcept
+{
+    QMutexLocker locker(&d->mtx);
+    return d->capacity;
+}
+
+void McStream::setCapacity(int val) noexcept
+{
+    QMutexLocker locker(&d->mtx);
+    d->capacity = qMax(1, val);
+    d->cond.wakeAll();
+}
+
+bool McStream::isClosed() const noexcept
+{
+    return d->isClosed.loadAcquire();
+}
+
+bool McStream::isAborted() const noexcept
+{
+    return d->isAborted.loadAcquire();
+}
+
+bool McStream::write(const QVariant &chunk) noexcept
+{
+    if (isClosed() || isAborted()) {
+        return false;
+    }
+    {
+        QMutexLocker locker(&d->mtx);
+        while (d->pending >= d->capacity && !isAborted()) {
+            d->cond.wait(&d->mtx);
+        }
+        if (isAborted()) {
+            return false;
+        }
+        ++d->pending;
+    }
+    QMutexLocker sinkLocker(&d->sinkMtx);
+    //! 没有接收端时直接丢弃，保证控制器不会被阻塞；接收端已析构时返回false
+    if (!d->sink) {
+        sinkLocker.unlock();
+        release();
+        return !isAborted();
+    }
+    if (!d->sink(chunk)) {
+        sinkLocker.unlock();
+        release();
+        return false;
+    }
+    return true;
+}
+
+void McStream::close() noexcept
+{
+    if (d->isClosed.fetchAndStoreOrdered(true)) {
+        return;
+    }
+    QMutexLocker sinkLocker(&d->sinkMtx);
+    if (d->completer && !isAborted()) {
+        d->completer();
+    }
+}
+
+void McStream::abort() noexcept
+{
+    QMutexLocker locker(&d->mtx);
+    d->isAborted.storeRelease(true);
+    d->cond.wakeAll();
+}
+
+void McStream::release() noexcept
+{
+    QMutexLocker locker(&d->mtx);
+    if (d->pending > 0) {
+        --d->pending;
+    }
+    d->cond.wakeAll();
+}
+
+void McStream::setSink(const std::function<bool(const QVariant &)> &sink,
+                       const std::function<void()> &completer) noexcept
+{
+    QMutexLocker locker(&d->sinkMtx);
+    d->sink = sink;
+    d->completer = completer;
+}
+
+void McStream::detach() noexcept
+{
+    //! 等待正在执行的回调结束，控制器线程持有的是共享状态而不是接收端本身
+    QMutexLocker locker(&d->sinkMtx);
+    d->sink = nullptr;
+    d->completer = nullptr;
+}
@@ -0,0 +1,118 @@
+#include "McSyslogCollector.h"
+
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QFile>
+#include <QThread>
+#include <QUdpSocket>
+
+#ifdef Q_OS_UNIX
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+McSyslogCollector::McSyslogCollector() {}
+
+McSyslogCollector::~McSyslogCollector()
+{
+#ifdef Q_OS_UNIX
+    if (m_unixFd != -1) {
+        ::close(m_unixFd);
+        QFile::remove(m_unixPath);
+    }
+#endif
+}
+
+bool McSyslogCollector::listenUdp() noexcept
+{
+    m_udp.reset(new QUdpSocket());
+    if (!m_udp->bind(QHostAddress::LocalHost, 0)) {
+        return false;
+    }
+    //! 批量测试一次会收到几百个数据报，避免被接收缓冲区丢弃
+    m_udp->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4 * 1024 * 1024);
+    return true;
+}
+
+quint16 McSyslogCollector::port() const noexcept
+{
+    return m_udp.isNull() ? 0 : m_udp->localPort();
+}
+
+bool McSyslogCollector::listenUnix(const QString &path) noexcept
+{
+#ifdef Q_OS_UNIX
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    auto encoded = QFile::encodeName(path);
+    if (static_cast<size_t>(encoded.size()) >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    memcpy(addr.sun_path, encoded.constData(), static_cast<size_t>(encoded.size()));
+    QFile::remove(path);
+    m_unixFd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (m_unixFd == -1) {
+        return false;
+    }
+    if (::bind(m_unixFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        ::close(m_unixFd);
+        m_unixFd = -1;
+        return false;
+    }
+    ::fcntl(m_unixFd, F_SETFL, ::fcntl(m_unixFd, F_GETFL, 0) | O_NONBLOCK);
+    m_unixPath = path;
+    return true;
+#else
+    Q_UNUSED(path)
+    return false;
+#endif
+}
+
+QByteArrayList McSyslogCollector::take(int count, int msecs) noexcept
+{
+    QByteArrayList datagrams;
+    QDeadlineTimer deadline(msecs);
+    while (datagrams.size() < count && !deadline.hasExpired()) {
+        //! appender与测试在同一线程，发送由投递给它的事件触发
+        QCoreApplication::processEvents();
+        readPending(datagrams);
+        if (datagrams.size() < count) {
+            QThread::msleep(1);
+        }
+    }
+    //! 再等一小段时间，确认没有多余的数据报
+    QCoreApplication::processEvents();
+    QThread::msleep(20);
+    readPending(datagrams);
+    return datagrams;
+}
+
+void McSyslogCollector::readPending(QByteArrayList &datagrams) noexcept
+{
+    if (!m_udp.isNull()) {
+        while (m_udp->hasPendingDatagrams()) {
+            QByteArray datagram(static_cast<int>(m_udp->pendingDatagramSize()), Qt::Uninitialized);
+            auto size = m_udp->readDatagram(datagram.data(), datagram.size());
+            if (size < 0) {
+                break;
+            }
+            datagram.truncate(static_cast<int>(size));
+            datagrams.append(datagram);
+        }
+    }
+#ifdef Q_OS_UNIX
+    if (m_unixFd != -1) {
+        char buffer[65536];
+        for (;;) {
+            auto size = ::recv(m_unixFd, buffer, sizeof(buffer), 0);
+            if (size < 0) {
+                break;
+            }
+            datagrams.append(QByteArray(buffer, static_cast<int>(size)));
+        }
+    }
+#endif
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QByteArrayList>
+#include <QScopedPointer>
+#include <QString>
+
+class QUdpSocket;
+
+/*!
+ * \brief The McSyslogCollector class
+ * 在本机监听UDP端口或Unix数据报套接字，收集McSyslogAppender发出的数据报
+ */
+class McSyslogCollector
+{
+public:
+    McSyslogCollector();
+    ~McSyslogCollector();
+
+    //! 绑定127.0.0.1上的随机端口
+    bool listenUdp() noexcept;
+    quint16 port() const noexcept;
+
+    //! 绑定Unix数据报套接字，Windows下返回false
+    bool listenUnix(const QString &path) noexcept;
+
+    /*!
+     * \brief take
+     * 处理事件循环使appender发出队列中的记录，直到收到count个数据报或超时，返回收到的数据报
+     */
+    QByteArrayList take(int count, int msecs = 5000) noexcept;
+
+private:
+    void readPending(QByteArrayList &datagrams) noexcept;
+
+private:
+    QScopedPointer<QUdpSocket> m_udp;
+    int m_unixFd{-1};
+    QString m_unixPath;
+};
@@ -0,0 +1,39 @@
+QT -= gui
+QT += network testlib
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+HEADERS += \
+        McSyslogCollector.h
+
+SOURCES += \
+        McSyslogCollector.cpp \
+        tst_syslogappender.cpp
+
+DESTDIR = $$PWD/../../bin/Tests
+MOC_DIR = $$PWD/../../moc/Tests/SyslogAppenderTest
+
+include($$PWD/../../common.pri)
+include($$PWD/../../McLogQt/McLogQtDepend.pri)
+
+win32 {
+    msvc {
+        CONFIG(release, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQt
+        else:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQtd
+    } else {
+        equals(QT_MAJOR_VERSION, 5):lessThan(QT_MINOR_VERSION, 13) {
+            CONFIG(release, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQt
+            else:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQtd
+        } else {
+            LIBS += -L$$PWD/../../bin/ -lMcLogQt
+        }
+    }
+} else:unix:!macx {
+    LIBS += -L$$PWD/../../bin/ -lMcLogQt
+}
+
+INCLUDEPATH += $$PWD/../../McLogQt/include
+DEPENDPATH += $$PWD/../../McLogQt/include
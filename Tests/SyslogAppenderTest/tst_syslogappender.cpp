@@ -0,0 +1,234 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QRegularExpression>
+#include <QtTest>
+
+#include "McLog/Appender/impl/McSyslogAppender.h"
+
+#include "McSyslogCollector.h"
+
+namespace {
+
+const QRegularExpression kFrameRe(QStringLiteral(R"(^<(\d{1,3})>1 (\d{4}-\d\d-\d\dT\d\d:\d\d:\d\d\.\d{3}Z) )"
+                                                 R"((\S+) (\S+) (\S+) (\S+) - (.*)$)"),
+                                  QRegularExpression::DotMatchesEverythingOption);
+
+} // namespace
+
+class SyslogAppenderTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void framing();
+    void severity_data();
+    void severity();
+    void truncation();
+    void batching();
+    void dropWhenQueueFull();
+    void dropWhenUnreachable();
+    void unixDatagram();
+
+private:
+    McSyslogAppenderPtr createUdpAppender(const McSyslogCollector &collector, int queueCapacity = 8192);
+    void append(const McSyslogAppenderPtr &appender, QtMsgType type, const QString &message);
+};
+
+McSyslogAppenderPtr SyslogAppenderTest::createUdpAppender(const McSyslogCollector &collector, int queueCapacity)
+{
+    auto appender = McSyslogAppenderPtr::create();
+    appender->setThreshold("debug-");
+    appender->setProtocol("udp");
+    appender->setHost("127.0.0.1");
+    appender->setPort(collector.port());
+    appender->setFacility("local0");
+    appender->setHostName("test-host");
+    appender->setAppName("mc test");
+    appender->setQueueCapacity(queueCapacity);
+    appender->finished();
+    appender->threadFinished();
+    appender->allFinished();
+    return appender;
+}
+
+void SyslogAppenderTest::append(const McSyslogAppenderPtr &appender, QtMsgType type, const QString &message)
+{
+    QMessageLogContext context("tst_syslogappender.cpp", 42, "void test()", "syslog.test");
+    appender->append(type, context, message);
+}
+
+void SyslogAppenderTest::framing()
+{
+    McSyslogCollector collector;
+    QVERIFY(collector.listenUdp());
+    auto appender = createUdpAppender(collector);
+
+    append(appender, QtWarningMsg, QStringLiteral("hello 中文"));
+    auto datagrams = collector.take(1);
+    QCOMPARE(datagrams.size(), 1);
+
+    auto match = kFrameRe.match(QString::fromUtf8(datagrams.first()));
+    QVERIFY2(match.hasMatch(), datagrams.first().constData());
+    QCOMPARE(match.captured(1).toInt(), 16 * 8 + 4); //!< local0，warning
+    auto timestamp = QDateTime::fromString(match.captured(2), Qt::ISODateWithMs);
+    QVERIFY(timestamp.isValid());
+    QVERIFY(qAbs(timestamp.msecsTo(QDateTime::currentDateTimeUtc())) < 60 * 1000);
+    QCOMPARE(match.captured(3), QStringLiteral("test-host"));
+    QCOMPARE(match.captured(4), QStringLiteral("mc_test")); //!< 头部字段中的空格被替换
+    QCOMPARE(match.captured(5).toLongLong(), QCoreApplication::applicationPid());
+    QCOMPARE(match.captured(6), QStringLiteral("syslog.test"));
+    QCOMPARE(match.captured(7), QStringLiteral("hello 中文"));
+    QCOMPARE(appender->droppedCount(), quint64(0));
+}
+
+void SyslogAppenderTest::severity_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<int>("severity");
+
+    QTest::newRow("debug") << static_cast<int>(QtDebugMsg) << 7;
+    QTest::newRow("info") << static_cast<int>(QtInfoMsg) << 6;
+    QTest::newRow("warning") << static_cast<int>(QtWarningMsg) << 4;
+    QTest::newRow("critical") << static_cast<int>(QtCriticalMsg) << 3;
+}
+
+void SyslogAppenderTest::severity()
+{
+    QFETCH(int, type);
+    QFETCH(int, severity);
+
+    McSyslogCollector collector;
+    QVERIFY(collector.listenUdp());
+    auto appender = createUdpAppender(collector);
+
+    append(appender, static_cast<QtMsgType>(type), QStringLiteral("severity"));
+    auto datagrams = collector.take(1);
+    QCOMPARE(datagrams.size(), 1);
+    auto match = kFrameRe.match(QString::fromUtf8(datagrams.first()));
+    QVERIFY(match.hasMatch());
+    QCOMPARE(match.captured(1).toInt(), 16 * 8 + severity);
+}
+
+void SyslogAppenderTest::truncation()
+{
+    McSyslogCollector collector;
+    QVERIFY(collector.listenUdp());
+    auto appender = McSyslogAppenderPtr::create();
+    appender->setThreshold("debug-");
+    appender->setHost("127.0.0.1");
+    appender->setPort(collector.port());
+    appender->setMaxDatagramSize(480);
+    appender->finished();
+
+    append(appender, QtInfoMsg, QString(1000, QChar(0x4E2D)));
+    auto datagrams = collector.take(1);
+    QCOMPARE(datagrams.size(), 1);
+    auto &datagram = datagrams.first();
+    QVERIFY(datagram.size() <= 480);
+    QVERIFY(datagram.size() > 470);
+    //! 截断位置不能落在多字节字符中间
+    QCOMPARE(QString::fromUtf8(datagram).toUtf8(), datagram);
+    QVERIFY(kFrameRe.match(QString::fromUtf8(datagram)).hasMatch());
+}
+
+void SyslogAppenderTest::batching()
+{
+    McSyslogCollector collector;
+    QVERIFY(collector.listenUdp());
+    auto appender = createUdpAppender(collector);
+
+    //! 不处理事件，记录全部留在队列中，由一次drain批量发出，数量超过sendmmsg的单批上限
+    constexpr int count = 300;
+    for (int i = 0; i < count; ++i) {
+        append(appender, QtInfoMsg, QStringLiteral("record %1").arg(i));
+    }
+    auto datagrams = collector.take(count);
+    QCOMPARE(datagrams.size(), count);
+    for (int i = 0; i < count; ++i) {
+        //! 每个数据报只包含一条记录，并且保持打印顺序
+        auto match = kFrameRe.match(QString::fromUtf8(datagrams.at(i)));
+        QVERIFY(match.hasMatch());
+        QCOMPARE(match.captured(7), QStringLiteral("record %1").arg(i));
+    }
+    QCOMPARE(appender->droppedCount(), quint64(0));
+}
+
+void SyslogAppenderTest::dropWhenQueueFull()
+{
+    McSyslogCollector collector;
+    QVERIFY(collector.listenUdp());
+    auto appender = createUdpAppender(collector, 16);
+
+    constexpr int count = 100;
+    for (int i = 0; i < count; ++i) {
+        append(appender, QtInfoMsg, QStringLiteral("record %1").arg(i));
+    }
+    //! 队列满时不阻塞调用线程，多出的记录立即计入丢弃数
+    QCOMPARE(appender->droppedCount(), quint64(count - 16));
+
+    auto datagrams = collector.take(16);
+    QCOMPARE(datagrams.size(), 16);
+    for (int i = 0; i < 16; ++i) {
+        auto match = kFrameRe.match(QString::fromUtf8(datagrams.at(i)));
+        QVERIFY(match.hasMatch());
+        QCOMPARE(match.captured(7), QStringLiteral("record %1").arg(i));
+    }
+    QCOMPARE(appender->droppedCount(), quint64(count - 16));
+}
+
+void SyslogAppenderTest::dropWhenUnreachable()
+{
+#ifdef Q_OS_UNIX
+    auto appender = McSyslogAppenderPtr::create();
+    appender->setThreshold("debug-");
+    appender->setProtocol("unix");
+    appender->setSocketPath(QDir::temp().absoluteFilePath("mc_syslog_test_missing.sock"));
+    appender->finished();
+
+    constexpr int count = 10;
+    for (int i = 0; i < count; ++i) {
+        append(appender, QtInfoMsg, QStringLiteral("record %1").arg(i));
+    }
+    QTRY_COMPARE(appender->droppedCount(), quint64(count));
+#else
+    QSKIP("unix datagram socket is not supported on this platform");
+#endif
+}
+
+void SyslogAppenderTest::unixDatagram()
+{
+#ifdef Q_OS_UNIX
+    McSyslogCollector collector;
+    auto path = QDir::temp().absoluteFilePath(
+        QStringLiteral("mc_syslog_test_%1.sock").arg(QCoreApplication::applicationPid()));
+    QVERIFY(collector.listenUnix(path));
+
+    auto appender = McSyslogAppenderPtr::create();
+    appender->setThreshold("debug-");
+    appender->setProtocol("unix");
+    appender->setSocketPath(path);
+    appender->setFacility("daemon");
+    appender->setHostName("test-host");
+    appender->setAppName("mctest");
+    appender->finished();
+
+    append(appender, QtCriticalMsg, QStringLiteral("over unix"));
+    append(appender, QtInfoMsg, QStringLiteral("second"));
+    auto datagrams = collector.take(2);
+    QCOMPARE(datagrams.size(), 2);
+    auto match = kFrameRe.match(QString::fromUtf8(datagrams.at(0)));
+    QVERIFY2(match.hasMatch(), datagrams.at(0).constData());
+    QCOMPARE(match.captured(1).toInt(), 3 * 8 + 3); //!< daemon，critical
+    QCOMPARE(match.captured(4), QStringLiteral("mctest"));
+    QCOMPARE(match.captured(7), QStringLiteral("over unix"));
+    match = kFrameRe.match(QString::fromUtf8(datagrams.at(1)));
+    QVERIFY(match.hasMatch());
+    QCOMPARE(match.captured(7), QStringLiteral("second"));
+    QCOMPARE(appender->droppedCount(), quint64(0));
+#else
+    QSKIP("unix datagram socket is not supported on this platform");
+#endif
+}
+
+QTEST_GUILESS_MAIN(SyslogAppenderTest)
+
+#include "tst_syslogappender.moc"
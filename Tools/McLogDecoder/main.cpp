@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+
+#include <McLog/Layout/impl/McNormalLayout.h>
+#include <McLog/Utils/McBinaryLog.h>
+
+//! 将McBinaryFileAppender写出的二进制日志转换为文本
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("McLogDecoder");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Decode binary log files written by McBinaryFileAppender into text.\n"
+        "%{pid} and %{appname} are those of the decoder, not of the logging process.");
+    parser.addHelpOption();
+    QCommandLineOption patternOption({"p", "pattern"},
+                                     "Message pattern, same as McPatternLayout. "
+                                     "Defaults to the pattern of McNormalLayout.",
+                                     "pattern");
+    QCommandLineOption outputOption({"o", "output"}, "Write to <file> instead of stdout.", "file");
+    parser.addOption(patternOption);
+    parser.addOption(outputOption);
+    parser.addPositionalArgument("files", "Binary log files to decode, in order.", "<file>...");
+    parser.process(app);
+
+    auto files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    auto layout = McNormalLayoutPtr::create();
+    layout->finished();
+    if (parser.isSet(patternOption)) {
+        layout->setPattern(parser.value(patternOption));
+    }
+
+    QFile out;
+    bool isOpened = false;
+    if (parser.isSet(outputOption)) {
+        out.setFileName(parser.value(outputOption));
+        isOpened = out.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    } else {
+        isOpened = out.open(stdout, QIODevice::WriteOnly);
+    }
+    if (!isOpened) {
+        qCritical("cannot open output: %s", qPrintable(out.errorString()));
+        return 1;
+    }
+
+    int ret = 0;
+    for (const auto &filePath : qAsConst(files)) {
+        QFile in(filePath);
+        if (!in.open(QIODevice::ReadOnly)) {
+            qCritical("cannot open '%s': %s", qPrintable(filePath), qPrintable(in.errorString()));
+            ret = 1;
+            continue;
+        }
+        McBinaryLogReader reader(&in);
+        if (!reader.readHeader()) {
+            qCritical("'%s': %s", qPrintable(filePath), qPrintable(reader.errorString()));
+            ret = 1;
+            continue;
+        }
+        McLogRecord record;
+        while (reader.readNext(record)) {
+            out.write(layout->formatRecord(record).toUtf8());
+            out.write("\n");
+        }
+        if (!reader.errorString().isEmpty()) {
+            //! 进程异常退出时最后一条记录可能不完整，之前的记录仍然有效
+            qWarning("'%s': %s", qPrintable(filePath), qPrintable(reader.errorString()));
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,38 @@
+QT -= gui
+
+CONFIG += console
+CONFIG -= app_bundle
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Refer to the documentation for the
+# deprecated API to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        main.cpp
+
+DESTDIR = $$PWD/../../bin/Tools
+MOC_DIR = $$PWD/../../moc/Tools/McLogSeek
+
+include($$PWD/../../common.pri)
+include($$PWD/../../McLogQt/McLogQtDepend.pri)
+
+win32 {
+    msvc {
+        CONFIG(release, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQt
+        else:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQtd
+    } else {
+        equals(QT_MAJOR_VERSION, 5):lessThan(QT_MINOR_VERSION, 13) {
+            CONFIG(release, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQt
+            else:CONFIG(debug, debug|release): LIBS += -L$$PWD/../../bin/ -lMcLogQtd
+        } else {
+            LIBS += -L$$PWD/../../bin/ -lMcLogQt
+        }
+    }
+} else:unix:!macx {
+    LIBS += -L$$PWD/../../bin/ -lMcLogQt
+}
+
+INCLUDEPATH += $$PWD/../../McLogQt/include
+DEPENDPATH += $$PWD/../../McLogQt/include
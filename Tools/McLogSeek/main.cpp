@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2021 mrcao20
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <limits>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+
+#include <McLog/Utils/McLogTimeIndex.h>
+
+namespace {
+
+//! 支持ISO 8601和yyyy-MM-dd hh:mm:ss，按本地时间解析
+bool parseTime(const QString &text, qint64 &msecs)
+{
+    auto dateTime = QDateTime::fromString(text, Qt::ISODateWithMs);
+    if (!dateTime.isValid()) {
+        dateTime = QDateTime::fromString(text, QStringLiteral("yyyy-MM-dd hh:mm:ss"));
+    }
+    if (!dateTime.isValid()) {
+        return false;
+    }
+    msecs = dateTime.toMSecsSinceEpoch();
+    return true;
+}
+
+} // namespace
+
+//! 根据文件追加器写出的.idx时间索引，从滚动和压缩后的日志中直接取出某个时间范围的内容
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("McLogSeek");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Print the part of log files within a time range, using the .idx time index written by "
+        "file appenders with indexInterval set. Compressed .gz segments are supported.\n"
+        "The range is aligned to index buckets, so up to one bucket of extra lines may be printed "
+        "at each end.");
+    parser.addHelpOption();
+    QCommandLineOption fromOption({"f", "from"}, "Start time, e.g. 2024-01-01T08:00:00.", "time");
+    QCommandLineOption toOption({"t", "to"}, "End time. Defaults to the end of the logs.", "time");
+    QCommandLineOption outputOption({"o", "output"}, "Write to <file> instead of stdout.", "file");
+    parser.addOption(fromOption);
+    parser.addOption(toOption);
+    parser.addOption(outputOption);
+    parser.addPositionalArgument("files", "Log files to search, oldest first.", "<file>...");
+    parser.process(app);
+
+    auto files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+    qint64 from = std::numeric_limits<qint64>::min();
+    qint64 to = std::numeric_limits<qint64>::max();
+    if (parser.isSet(fromOption) && !parseTime(parser.value(fromOption), from)) {
+        qCritical("invalid time: %s", qPrintable(parser.value(fromOption)));
+        return 1;
+    }
+    if (parser.isSet(toOption) && !parseTime(parser.value(toOption), to)) {
+        qCritical("invalid time: %s", qPrintable(parser.value(toOption)));
+        return 1;
+    }
+
+    QFile out;
+    bool isOpened = false;
+    if (parser.isSet(outputOption)) {
+        out.setFileName(parser.value(outputOption));
+        isOpened = out.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    } else {
+        isOpened = out.open(stdout, QIODevice::WriteOnly);
+    }
+    if (!isOpened) {
+        qCritical("cannot open output: %s", qPrintable(out.errorString()));
+        return 1;
+    }
+
+    int ret = 0;
+    for (const auto &filePath : qAsConst(files)) {
+        if (!McLogTimeIndex::copyRange(filePath, from, to, &out)) {
+            qCritical("'%s': no usable time index or read error", qPrintable(filePath));
+            ret = 1;
+        }
+    }
+    return ret;
+}